@@ -12,16 +12,41 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
+#include <cstring>
 #include <list>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     ReplacerType replacer_type, DiskScheduler *disk_scheduler)
+    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager), disk_scheduler_(disk_scheduler) {
+  if (disk_scheduler_ == nullptr) {
+    owned_disk_scheduler_ = std::make_unique<DiskScheduler>(disk_manager_);
+    disk_scheduler_ = owned_disk_scheduler_.get();
+  }
   // We allocate a consecutive memory space for the buffer pool.
   pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  num_frame_hints_ = std::max<size_t>(1, 2 * pool_size_);
+  frame_hints_ = std::make_unique<std::atomic<frame_id_t>[]>(num_frame_hints_);
+  switch (replacer_type) {
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -30,11 +55,15 @@ BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  StopPrefetcher();
+  StopPageCleaner();
   delete[] pages_;
   delete replacer_;
 }
 
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) { return FetchPageWithStrategyImpl(page_id, nullptr); }
+
+Page *BufferPoolManager::FetchPageWithStrategyImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -43,36 +72,117 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
   std::unique_lock<std::mutex> guard(latch_);
-  if (page_table_.count(page_id) >= 1) {
-    auto frame_id = page_table_[page_id];
-    if (pages_[frame_id].pin_count_ == 0) {
-      replacer_->Pin(frame_id);
+  while (true) {
+    auto iter = page_table_.find(page_id);
+    if (iter != page_table_.end()) {
+      auto frame_id = iter->second;
+      if (pages_[frame_id].pin_count_ == 0) {
+        replacer_->Pin(frame_id);
+      }
+      pages_[frame_id].pin_count_++;
+      replacer_->RecordAccess(frame_id);
+      SetFrameHint(page_id, frame_id);
+      // another thread may still be reading the page in, wait for it instead of issuing a second read
+      io_cv_.wait(guard, [&] { return !pages_[frame_id].is_io_in_progress_; });
+      if (pages_[frame_id].page_id_ != page_id) {
+        // that read failed and the page left the frame again, try it ourselves
+        ReleaseFramePin(frame_id);
+        continue;
+      }
+      return pages_ + frame_id;
+    }
+    if (writing_pages_.count(page_id) == 0 && cleaning_pages_.count(page_id) == 0) {
+      break;
     }
-    pages_[frame_id].pin_count_++;
-    return pages_ + frame_id;
+    // the page has just been evicted and a write of it is still in flight, read it only once that is done
+    io_cv_.wait(guard);
   }
 
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else if (replacer_->Victim(&frame_id)) {
-    page_table_.erase(pages_[frame_id].GetPageId());
-
-    // no need to acquire the wlatch of this page since no thread pins it
-    InternalFlushPage(frame_id, false);
-  } else {
-    return nullptr;
+  page_id_t evicted_page_id;
+  if (strategy == nullptr || !FindRingFrame(strategy, &frame_id, &evicted_page_id)) {
+    if (!FindFreeFrame(&frame_id, &evicted_page_id)) {
+      return nullptr;
+    }
+  }
+  if (strategy != nullptr) {
+    AdvanceRing(strategy, frame_id, page_id);
   }
 
   page_table_[page_id] = frame_id;
+  SetFrameHint(page_id, frame_id);
+
+  Page *page = pages_ + frame_id;
+  BeginFrameReuse(page);
+  page->pin_count_ = 1;
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->is_io_in_progress_ = true;
+  replacer_->RecordAccess(frame_id);
+
+  if (evicted_page_id != INVALID_PAGE_ID) {
+    // the page cleaner may still be writing an older image of the evicted page, ours has to land after it
+    io_cv_.wait(guard, [&] { return cleaning_pages_.count(evicted_page_id) == 0; });
+  }
+
+  // no other thread can touch the frame until is_io_in_progress_ is cleared, so the latch is not needed for the I/O
+  guard.unlock();
+  bool written = true;
+  if (evicted_page_id != INVALID_PAGE_ID) {
+    written = disk_scheduler_->ScheduleWrite(evicted_page_id, page->GetData()).get();
+    foreground_flush_count_++;
+  }
+  bool read = written && disk_scheduler_->ScheduleRead(page_id, page->GetData()).get();
+  guard.lock();
+
+  if (!read) {
+    AbandonFrame(frame_id, page_id, written ? INVALID_PAGE_ID : evicted_page_id);
+    FinishFrameIO(frame_id, evicted_page_id);
+    return nullptr;
+  }
+  FinishFrameIO(frame_id, evicted_page_id);
+  return page;
+}
 
-  pages_[frame_id].pin_count_ = 1;
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].is_dirty_ = false;
-  disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+Page *BufferPoolManager::FetchPageOptimisticImpl(page_id_t page_id, uint64_t *version) {
+  for (int choice = 0; choice < 2; choice++) {
+    Page *page = pages_ + FrameHint(page_id, choice).load(std::memory_order_relaxed);
+    // BeginFrameReuse makes the version odd before it looks for pins, and we pin before we look at the version, so
+    // either we see the odd version or it waits for us
+    page->optimistic_pins_.fetch_add(1, std::memory_order_seq_cst);
+    *version = page->version_.load(std::memory_order_seq_cst);
+    if (*version % 2 == 0 && page->page_id_ == page_id) {
+      return page;
+    }
+    UnpinPageOptimistic(page);
+  }
+  return nullptr;
+}
 
-  return pages_ + frame_id;
+void BufferPoolManager::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!enable_prefetcher_) {
+    return;
+  }
+  for (auto page_id : page_ids) {
+    // a prefetch is only a hint, do not let the queue grow beyond what the pool could hold anyway
+    if (page_id == INVALID_PAGE_ID || prefetch_queue_.size() >= pool_size_ || page_table_.count(page_id) > 0 ||
+        prefetching_pages_.count(page_id) > 0) {
+      continue;
+    }
+    if (strategy != nullptr) {
+      strategy->BeginPrefetch();
+    }
+    prefetch_queue_.push_back({page_id, strategy});
+    prefetching_pages_.insert(page_id);
+  }
+  if (prefetch_queue_.empty()) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_thread_ = new std::thread(&BufferPoolManager::RunPrefetcher, this);
+  }
+  prefetch_cv_.notify_one();
 }
 
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
@@ -94,19 +204,11 @@ bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
   return true;
 }
 
-bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  std::unique_lock<std::mutex> guard(latch_);
-  if (page_table_.count(page_id) >= 1) {
-    auto frame_id = page_table_[page_id];
-    pages_[frame_id].RLatch();
-    InternalFlushPage(frame_id, true);
-    pages_[frame_id].RUnlatch();
-    return true;
-  }
-  return false;
-}
+bool BufferPoolManager::FlushPageImpl(page_id_t page_id) { return InternalFlushPage(page_id, true); }
 
-Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
+Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) { return NewPageInSegmentImpl(page_id, nullptr); }
+
+Page *BufferPoolManager::NewPageInSegmentImpl(page_id_t *page_id, Segment *segment) {
   // 0.   Make sure you call DiskManager::AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
@@ -114,25 +216,30 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
   // 4.   Set the page ID output parameter. Return a pointer to P.
   std::unique_lock<std::mutex> guard(latch_);
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else if (replacer_->Victim(&frame_id)) {
-    page_table_.erase(pages_[frame_id].GetPageId());
-    InternalFlushPage(frame_id, false);
-  } else {
+  page_id_t evicted_page_id;
+  if (!FindFreeFrame(&frame_id, &evicted_page_id)) {
     return nullptr;
   }
 
-  *page_id = disk_manager_->AllocatePage();
-  pages_[frame_id].page_id_ = *page_id;
-  pages_[frame_id].is_dirty_ = false;
-  pages_[frame_id].pin_count_ = 1;
-  pages_[frame_id].ResetMemory();
+  *page_id = AllocatePage(segment);
+  Page *page = NewPageInFrame(frame_id, *page_id, evicted_page_id, &guard);
+  if (page == nullptr) {
+    // the page id is not used after all
+    disk_manager_->DeallocatePage(*page_id);
+    *page_id = INVALID_PAGE_ID;
+  }
+  return page;
+}
 
-  page_table_[*page_id] = frame_id;
+Page *BufferPoolManager::InstallNewPage(page_id_t page_id) {
+  std::unique_lock<std::mutex> guard(latch_);
+  frame_id_t frame_id;
+  page_id_t evicted_page_id;
+  if (!FindFreeFrame(&frame_id, &evicted_page_id)) {
+    return nullptr;
+  }
 
-  return pages_ + frame_id;
+  return NewPageInFrame(frame_id, page_id, evicted_page_id, &guard);
 }
 
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
@@ -143,12 +250,20 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
 
   std::unique_lock<std::mutex> guard(latch_);
+  // do not let the page id be reused while an old image of the page is still being written
+  io_cv_.wait(guard, [&] { return writing_pages_.count(page_id) == 0 && cleaning_pages_.count(page_id) == 0; });
   if (page_table_.count(page_id) >= 1) {
     auto frame_id = page_table_[page_id];
     if (pages_[frame_id].pin_count_ >= 1) {
       return false;
     }
+    // the frame is unpinned and therefore still a candidate in the replacer, it must only be in the free list
+    replacer_->Remove(frame_id);
     page_table_.erase(page_id);
+    BeginFrameReuse(pages_ + frame_id);
+    pages_[frame_id].page_id_ = INVALID_PAGE_ID;
+    pages_[frame_id].is_dirty_ = false;
+    EndFrameReuse(pages_ + frame_id);
     free_list_.push_back(frame_id);
   }
 
@@ -158,19 +273,374 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
 }
 
 void BufferPoolManager::FlushAllPagesImpl() {
+  WriteBackAllPages();
+  disk_manager_->SyncDatabase();
+}
+
+void BufferPoolManager::WriteBackAllPages() {
+  std::vector<page_id_t> page_ids;
+  {
+    std::unique_lock<std::mutex> guard(latch_);
+    page_ids.reserve(page_table_.size());
+    for (auto kv : page_table_) {
+      page_ids.push_back(kv.first);
+    }
+  }
+  for (auto page_id : page_ids) {
+    InternalFlushPage(page_id, false);
+  }
+}
+
+bool BufferPoolManager::FindFreeFrame(frame_id_t *frame_id, page_id_t *evicted_page_id) {
+  *evicted_page_id = INVALID_PAGE_ID;
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (replacer_->Victim(frame_id)) {
+    Page *victim = pages_ + *frame_id;
+    page_table_.erase(victim->GetPageId());
+    // the page cleaner's write of a page may still fail, until it is done the page is written back like a dirty one
+    if (victim->IsDirty() || cleaning_pages_.count(victim->GetPageId()) > 0) {
+      *evicted_page_id = victim->GetPageId();
+      writing_pages_.insert(*evicted_page_id);
+    }
+    return true;
+  }
+  return false;
+}
+
+bool BufferPoolManager::FindRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                      page_id_t *evicted_page_id) {
+  auto &ring = *strategy->GetRing(this);
+  if (ring.next_ >= ring.slots_.size()) {
+    return false;
+  }
+  auto slot = ring.slots_[ring.next_];
+  Page *page = pages_ + slot.frame_id_;
+  // the frame may have been evicted and reused by someone else since, or be in use right now
+  if (page->page_id_ != slot.page_id_ || page->pin_count_ > 0 || page->is_io_in_progress_) {
+    return false;
+  }
+
+  replacer_->Remove(slot.frame_id_);
+  page_table_.erase(slot.page_id_);
+  *frame_id = slot.frame_id_;
+  *evicted_page_id = INVALID_PAGE_ID;
+  if (page->IsDirty() || cleaning_pages_.count(slot.page_id_) > 0) {
+    *evicted_page_id = slot.page_id_;
+    writing_pages_.insert(*evicted_page_id);
+  }
+  return true;
+}
+
+void BufferPoolManager::AdvanceRing(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id) {
+  auto &ring = *strategy->GetRing(this);
+  // never let a single scan take more than a quarter of a small buffer pool
+  size_t ring_size = std::min(strategy->ring_size_, std::max<size_t>(2, pool_size_ / 4));
+  if (ring.next_ >= ring.slots_.size()) {
+    ring.slots_.push_back({frame_id, page_id});
+  } else {
+    ring.slots_[ring.next_] = {frame_id, page_id};
+  }
+  ring.next_ = (ring.next_ + 1) % ring_size;
+}
+
+Page *BufferPoolManager::NewPageInFrame(frame_id_t frame_id, page_id_t page_id, page_id_t evicted_page_id,
+                                        std::unique_lock<std::mutex> *guard) {
+  // A deallocated page id can be handed out again while the pool still holds an image of the deleted page, e.g. when
+  // a prefetch of it was queued before the delete. That image is stale: wait until nobody uses it and drop it.
+  while (true) {
+    auto iter = page_table_.find(page_id);
+    if (iter == page_table_.end()) {
+      break;
+    }
+    auto stale_frame_id = iter->second;
+    if (pages_[stale_frame_id].pin_count_ == 0 && !pages_[stale_frame_id].is_io_in_progress_) {
+      replacer_->Remove(stale_frame_id);
+      page_table_.erase(iter);
+      BeginFrameReuse(pages_ + stale_frame_id);
+      pages_[stale_frame_id].page_id_ = INVALID_PAGE_ID;
+      pages_[stale_frame_id].is_dirty_ = false;
+      EndFrameReuse(pages_ + stale_frame_id);
+      free_list_.push_back(stale_frame_id);
+      break;
+    }
+    io_cv_.wait(*guard);
+  }
+
+  page_table_[page_id] = frame_id;
+  SetFrameHint(page_id, frame_id);
+
+  Page *page = pages_ + frame_id;
+  BeginFrameReuse(page);
+  page->page_id_ = page_id;
+  page->is_dirty_ = false;
+  page->pin_count_ = 1;
+  replacer_->RecordAccess(frame_id);
+
+  if (evicted_page_id == INVALID_PAGE_ID) {
+    page->ResetMemory();
+    EndFrameReuse(page);
+    return page;
+  }
+
+  page->is_io_in_progress_ = true;
+  io_cv_.wait(*guard, [&] { return cleaning_pages_.count(evicted_page_id) == 0; });
+  guard->unlock();
+  bool written = disk_scheduler_->ScheduleWrite(evicted_page_id, page->GetData()).get();
+  foreground_flush_count_++;
+  if (written) {
+    page->ResetMemory();
+  }
+  guard->lock();
+
+  if (!written) {
+    AbandonFrame(frame_id, page_id, evicted_page_id);
+    FinishFrameIO(frame_id, evicted_page_id);
+    return nullptr;
+  }
+  FinishFrameIO(frame_id, evicted_page_id);
+  return page;
+}
+
+void BufferPoolManager::AbandonFrame(frame_id_t frame_id, page_id_t page_id, page_id_t evicted_page_id) {
+  Page *page = pages_ + frame_id;
+  page_table_.erase(page_id);
+  page->page_id_ = evicted_page_id;
+  // the evicted page is still newer than its image on disk
+  page->is_dirty_ = evicted_page_id != INVALID_PAGE_ID;
+  if (evicted_page_id != INVALID_PAGE_ID) {
+    page_table_[evicted_page_id] = frame_id;
+    SetFrameHint(evicted_page_id, frame_id);
+  }
+  ReleaseFramePin(frame_id);
+}
+
+void BufferPoolManager::ReleaseFramePin(frame_id_t frame_id) {
+  Page *page = pages_ + frame_id;
+  page->pin_count_--;
+  if (page->pin_count_ > 0) {
+    return;
+  }
+  if (page->page_id_ != INVALID_PAGE_ID) {
+    replacer_->Unpin(frame_id);
+    return;
+  }
+  replacer_->Remove(frame_id);
+  free_list_.push_back(frame_id);
+}
+
+void BufferPoolManager::FinishFrameIO(frame_id_t frame_id, page_id_t evicted_page_id) {
+  if (evicted_page_id != INVALID_PAGE_ID) {
+    writing_pages_.erase(evicted_page_id);
+  }
+  pages_[frame_id].is_io_in_progress_ = false;
+  EndFrameReuse(pages_ + frame_id);
+  io_cv_.notify_all();
+}
+
+void BufferPoolManager::SetFrameHint(page_id_t page_id, frame_id_t frame_id) {
+  std::atomic<frame_id_t> *hints[] = {&FrameHint(page_id, 0), &FrameHint(page_id, 1)};
+  if (hints[0]->load(std::memory_order_relaxed) == frame_id || hints[1]->load(std::memory_order_relaxed) == frame_id) {
+    return;
+  }
+  // an entry is free if its frame holds no page that the entry belongs to, otherwise the first one is taken over
+  for (auto *hint : hints) {
+    page_id_t other_page_id = pages_[hint->load(std::memory_order_relaxed)].page_id_;
+    if (other_page_id == INVALID_PAGE_ID ||
+        (&FrameHint(other_page_id, 0) != hint && &FrameHint(other_page_id, 1) != hint)) {
+      hint->store(frame_id, std::memory_order_relaxed);
+      return;
+    }
+  }
+  hints[0]->store(frame_id, std::memory_order_relaxed);
+}
+
+void BufferPoolManager::BeginFrameReuse(Page *page) {
+  page->version_.fetch_add(1, std::memory_order_seq_cst);
+  // the optimistic readers that pinned the frame before it became odd only read it, they are done soon
+  while (page->optimistic_pins_.load(std::memory_order_acquire) > 0) {
+    std::this_thread::yield();
+  }
+}
+
+void BufferPoolManager::EndFrameReuse(Page *page) { page->version_.fetch_add(1, std::memory_order_release); }
+
+bool BufferPoolManager::InternalFlushPage(page_id_t page_id, bool force) {
   std::unique_lock<std::mutex> guard(latch_);
-  for (auto kv : page_table_) {
-    auto frame_id = kv.second;
-    pages_[frame_id].RLatch();
-    InternalFlushPage(frame_id, false);
-    pages_[frame_id].RUnlatch();
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    return false;
+  }
+  auto frame_id = iter->second;
+  Page *page = pages_ + frame_id;
+
+  // pin the page so that it stays in its frame while the latch is released
+  if (page->pin_count_ == 0) {
+    replacer_->Pin(frame_id);
   }
+  page->pin_count_++;
+  io_cv_.wait(guard, [&] { return !page->is_io_in_progress_ && cleaning_pages_.count(page_id) == 0; });
+
+  bool written = true;
+  if (page->IsDirty() || force) {
+    // clear the dirty flag before the write, so that a modification made during the write marks the page dirty again
+    page->is_dirty_ = false;
+    guard.unlock();
+    page->RLatch();
+    written = disk_scheduler_->ScheduleWrite(page_id, page->GetData()).get();
+    page->RUnlatch();
+    guard.lock();
+    if (!written) {
+      page->is_dirty_ = true;
+    }
+  }
+
+  page->pin_count_--;
+  if (page->pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+  return written;
 }
 
-void BufferPoolManager::InternalFlushPage(frame_id_t frame_id, bool force) {
-  if (pages_[frame_id].IsDirty() || force) {
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
+void BufferPoolManager::StartPageCleaner(std::chrono::milliseconds interval, size_t max_pages) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (page_cleaner_thread_ != nullptr) {
+    return;
+  }
+  enable_page_cleaner_ = true;
+  page_cleaner_interval_ = interval;
+  page_cleaner_max_pages_ = max_pages;
+  page_cleaner_thread_ = new std::thread(&BufferPoolManager::RunPageCleaner, this);
+}
+
+void BufferPoolManager::StopPageCleaner() {
+  std::thread *page_cleaner_thread;
+  {
+    std::unique_lock<std::mutex> guard(latch_);
+    enable_page_cleaner_ = false;
+    page_cleaner_thread = page_cleaner_thread_;
+    page_cleaner_thread_ = nullptr;
+  }
+  if (page_cleaner_thread == nullptr) {
+    return;
+  }
+  page_cleaner_cv_.notify_all();
+  page_cleaner_thread->join();
+  delete page_cleaner_thread;
+}
+
+void BufferPoolManager::RunPageCleaner() {
+  std::vector<char> buffer(page_cleaner_max_pages_ * PAGE_SIZE);
+  std::vector<std::pair<page_id_t, frame_id_t>> candidates;
+  std::unique_lock<std::mutex> guard(latch_);
+  while (true) {
+    page_cleaner_cv_.wait_for(guard, page_cleaner_interval_, [&] { return !enable_page_cleaner_; });
+    if (!enable_page_cleaner_) {
+      break;
+    }
+
+    // Nobody can latch an unpinned page, and nobody can pin it while we hold latch_, so it is safe to copy it here.
+    candidates.clear();
+    for (size_t i = 0; i < pool_size_; i++) {
+      Page *page = pages_ + i;
+      if (page->page_id_ != INVALID_PAGE_ID && page->is_dirty_ && page->pin_count_ == 0 &&
+          !page->is_io_in_progress_ && cleaning_pages_.count(page->page_id_) == 0) {
+        candidates.emplace_back(page->page_id_, static_cast<frame_id_t>(i));
+      }
+    }
+    size_t num_pages = std::min(candidates.size(), page_cleaner_max_pages_);
+    std::partial_sort(candidates.begin(), candidates.begin() + num_pages, candidates.end());
+    for (size_t i = 0; i < num_pages; i++) {
+      Page *page = pages_ + candidates[i].second;
+      memcpy(buffer.data() + i * PAGE_SIZE, page->GetData(), PAGE_SIZE);
+      page->is_dirty_ = false;
+      cleaning_pages_.insert(candidates[i].first);
+    }
+    if (num_pages == 0) {
+      continue;
+    }
+
+    // submit the whole round at once, so that the writes are in flight together
+    guard.unlock();
+    std::vector<DiskRequest> requests;
+    std::vector<std::future<bool>> futures;
+    for (size_t i = 0; i < num_pages; i++) {
+      requests.push_back({true, buffer.data() + i * PAGE_SIZE, candidates[i].first, std::promise<bool>(), nullptr});
+      futures.push_back(requests.back().callback_.get_future());
+    }
+    disk_scheduler_->Schedule(std::move(requests));
+    std::vector<bool> written(num_pages);
+    for (size_t i = 0; i < num_pages; i++) {
+      written[i] = futures[i].get();
+    }
+    guard.lock();
+
+    for (size_t i = 0; i < num_pages; i++) {
+      cleaning_pages_.erase(candidates[i].first);
+      Page *page = pages_ + candidates[i].second;
+      if (!written[i]) {
+        // the page is still in its frame, an eviction meanwhile would have written it back itself
+        if (page->page_id_ == candidates[i].first) {
+          page->is_dirty_ = true;
+        }
+        continue;
+      }
+      background_flush_count_++;
+    }
+    io_cv_.notify_all();
+  }
+}
+
+void BufferPoolManager::StopPrefetcher() {
+  std::thread *prefetch_thread;
+  {
+    std::unique_lock<std::mutex> guard(latch_);
+    enable_prefetcher_ = false;
+    prefetch_thread = prefetch_thread_;
+    prefetch_thread_ = nullptr;
+  }
+  if (prefetch_thread != nullptr) {
+    prefetch_cv_.notify_all();
+    prefetch_thread->join();
+    delete prefetch_thread;
+  }
+
+  std::unique_lock<std::mutex> guard(latch_);
+  for (auto &request : prefetch_queue_) {
+    if (request.strategy_ != nullptr) {
+      request.strategy_->EndPrefetch();
+    }
+  }
+  prefetch_queue_.clear();
+  prefetching_pages_.clear();
+}
+
+void BufferPoolManager::RunPrefetcher() {
+  std::unique_lock<std::mutex> guard(latch_);
+  while (true) {
+    prefetch_cv_.wait(guard, [&] { return !enable_prefetcher_ || !prefetch_queue_.empty(); });
+    if (!enable_prefetcher_) {
+      break;
+    }
+    auto request = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+
+    guard.unlock();
+    // the read happens with latch_ released, and a FetchPage of the same page meanwhile waits for it to finish
+    if (BufferPoolManager::FetchPageWithStrategyImpl(request.page_id_, request.strategy_) != nullptr) {
+      BufferPoolManager::UnpinPageImpl(request.page_id_, false);
+    }
+    guard.lock();
+
+    prefetching_pages_.erase(request.page_id_);
+    if (request.strategy_ != nullptr) {
+      request.strategy_->EndPrefetch();
+    }
+    // a new page may be waiting for the prefetched image to be unpinned
+    io_cv_.notify_all();
   }
 }
 
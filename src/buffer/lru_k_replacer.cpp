@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_reference_period)
+    : k_(k), correlated_reference_period_(correlated_reference_period), records_(num_pages) {
+  BUSTUB_ASSERT(k_ > 0, "K must be positive.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::scoped_lock lock(latch_);
+  // prefer frames that are outside their correlated reference period, in order of backward K-distance
+  frame_id_t fallback = -1;
+  for (auto *frames : {&young_frames_, &old_frames_}) {
+    for (const auto &key : *frames) {
+      if (fallback == -1) {
+        fallback = key.second;
+      }
+      if (current_timestamp_ - records_[key.second].last_access_ >= correlated_reference_period_) {
+        *frame_id = key.second;
+        InternalErase(*frame_id);
+        return true;
+      }
+    }
+  }
+  if (fallback == -1) {
+    return false;
+  }
+  *frame_id = fallback;
+  InternalErase(*frame_id);
+  return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &record = records_[frame_id];
+  if (!record.evictable_) {
+    return;
+  }
+  FrameSet(record)->erase({record.history_.front(), frame_id});
+  record.evictable_ = false;
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  auto &record = records_[frame_id];
+  if (record.evictable_) {
+    return;
+  }
+  if (record.history_.empty()) {
+    // the frame has never been accessed through RecordAccess, count becoming evictable as its first access
+    InternalRecordAccess(frame_id);
+  }
+  record.evictable_ = true;
+  FrameSet(record)->insert({record.history_.front(), frame_id});
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  InternalRecordAccess(frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock lock(latch_);
+  InternalErase(frame_id);
+}
+
+size_t LRUKReplacer::Size() {
+  std::scoped_lock lock(latch_);
+  return young_frames_.size() + old_frames_.size();
+}
+
+std::set<LRUKReplacer::FrameKey> *LRUKReplacer::FrameSet(const FrameRecord &record) {
+  return record.history_.size() < k_ ? &young_frames_ : &old_frames_;
+}
+
+void LRUKReplacer::InternalRecordAccess(frame_id_t frame_id) {
+  auto &record = records_[frame_id];
+  size_t now = ++current_timestamp_;
+  if (!record.history_.empty() && now - record.last_access_ < correlated_reference_period_) {
+    record.last_access_ = now;
+    return;
+  }
+
+  if (record.evictable_) {
+    FrameSet(record)->erase({record.history_.front(), frame_id});
+  }
+  if (!record.history_.empty()) {
+    // collapse the correlated burst that just ended into a single access at its last reference, and shift the older
+    // history by the same amount so that the burst does not make the frame look older than it is
+    size_t correlated_period = record.last_access_ - record.history_.back();
+    for (auto &timestamp : record.history_) {
+      timestamp += correlated_period;
+    }
+  }
+  record.history_.push_back(now);
+  if (record.history_.size() > k_) {
+    record.history_.pop_front();
+  }
+  record.last_access_ = now;
+  if (record.evictable_) {
+    FrameSet(record)->insert({record.history_.front(), frame_id});
+  }
+}
+
+void LRUKReplacer::InternalErase(frame_id_t frame_id) {
+  auto &record = records_[frame_id];
+  if (record.evictable_) {
+    FrameSet(record)->erase({record.history_.front(), frame_id});
+  }
+  record.history_.clear();
+  record.last_access_ = 0;
+  record.evictable_ = false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
+    : BufferPoolManager(0, disk_manager, log_manager), num_instances_(num_instances), instance_pool_size_(pool_size) {
+  BUSTUB_ASSERT(num_instances_ > 0, "A parallel buffer pool needs at least one instance.");
+  instances_.reserve(num_instances_);
+  for (size_t i = 0; i < num_instances_; ++i) {
+    // all instances share the disk scheduler of this buffer pool, so that their I/O is submitted together
+    instances_.emplace_back(std::make_unique<BufferPoolManager>(instance_pool_size_, disk_manager, log_manager,
+                                                                replacer_type, disk_scheduler_));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  return instances_[static_cast<size_t>(page_id) % num_instances_].get();
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FetchPageImpl(page_id);
+}
+
+Page *ParallelBufferPoolManager::FetchPageWithStrategyImpl(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategyImpl(page_id, strategy);
+}
+
+Page *ParallelBufferPoolManager::FetchPageOptimisticImpl(page_id_t page_id, uint64_t *version) {
+  return GetBufferPoolManager(page_id)->FetchPageOptimisticImpl(page_id, version);
+}
+
+void ParallelBufferPoolManager::PrefetchPagesImpl(const std::vector<page_id_t> &page_ids,
+                                                  BufferAccessStrategy *strategy) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  for (auto page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      instance_page_ids[static_cast<size_t>(page_id) % num_instances_].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < num_instances_; i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->PrefetchPagesImpl(instance_page_ids[i], strategy);
+    }
+  }
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  return GetBufferPoolManager(page_id)->UnpinPageImpl(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FlushPageImpl(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) { return NewPageInSegmentImpl(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPageInSegmentImpl(page_id_t *page_id, Segment *segment) {
+  // Fresh page ids map to consecutive instances, but reused ones can map to any instance. Keep allocating until every
+  // instance has been asked once. Rejected ids are kept until we are done so that the disk manager cannot hand them
+  // out again.
+  std::vector<page_id_t> rejected_page_ids;
+  std::vector<bool> asked(num_instances_, false);
+  size_t num_asked = 0;
+  Page *page = nullptr;
+  while (page == nullptr && num_asked < num_instances_) {
+    *page_id = AllocatePage(segment);
+    size_t instance_index = static_cast<size_t>(*page_id) % num_instances_;
+    if (!asked[instance_index]) {
+      asked[instance_index] = true;
+      num_asked++;
+      page = instances_[instance_index]->InstallNewPage(*page_id);
+    }
+    if (page == nullptr) {
+      rejected_page_ids.push_back(*page_id);
+    }
+  }
+  for (auto rejected_page_id : rejected_page_ids) {
+    disk_manager_->DeallocatePage(rejected_page_id);
+  }
+  if (page == nullptr) {
+    *page_id = INVALID_PAGE_ID;
+  }
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->DeletePageImpl(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // sync once for all instances, they share the database file
+  for (auto &instance : instances_) {
+    instance->WriteBackAllPages();
+  }
+  disk_manager_->SyncDatabase();
+}
+
+void ParallelBufferPoolManager::StartPageCleaner(std::chrono::milliseconds interval, size_t max_pages) {
+  for (auto &instance : instances_) {
+    instance->StartPageCleaner(interval, max_pages);
+  }
+}
+
+void ParallelBufferPoolManager::StopPageCleaner() {
+  for (auto &instance : instances_) {
+    instance->StopPageCleaner();
+  }
+}
+
+size_t ParallelBufferPoolManager::GetForegroundFlushCount() {
+  size_t count = 0;
+  for (auto &instance : instances_) {
+    count += instance->GetForegroundFlushCount();
+  }
+  return count;
+}
+
+size_t ParallelBufferPoolManager::GetBackgroundFlushCount() {
+  size_t count = 0;
+  for (auto &instance : instances_) {
+    count += instance->GetBackgroundFlushCount();
+  }
+  return count;
+}
+
+}  // namespace bustub
@@ -0,0 +1,534 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.cpp
+//
+// Identification: src/container/hash/extendible_hash_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+EXTENDIBLE_HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                                                const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPageInSegment(&directory_page_id_, &segment_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+  }
+  auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+  directory_page->SetPageId(directory_page_id_);
+  directory_page->SetDirectoryPageId(0, directory_page_id_);
+  directory_page_ids_.push_back(directory_page_id_);
+
+  // a single bucket of local depth 0 in a directory of global depth 0
+  page_id_t bucket_page_id;
+  Page *bucket = buffer_pool_manager_->NewPageInSegment(&bucket_page_id, &segment_);
+  if (bucket == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+  }
+  reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(bucket->GetData())->Init();
+  directory_page->SetBucketPageId(0, bucket_page_id);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *EXTENDIBLE_HASH_TABLE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::Hash(const KeyType &key) {
+  return static_cast<uint32_t>(hash_fn_.GetHash(key));
+}
+
+/*****************************************************************************
+ * DIRECTORY
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t EXTENDIBLE_HASH_TABLE_TYPE::GetBucketPageId(uint32_t directory_idx) {
+  page_id_t page_id = directory_page_ids_[directory_idx / DIRECTORY_ARRAY_SIZE];
+  auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(FetchPage(page_id)->GetData());
+  page_id_t bucket_page_id = directory_page->GetBucketPageId(directory_idx % DIRECTORY_ARRAY_SIZE);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetLocalDepth(uint32_t directory_idx) {
+  page_id_t page_id = directory_page_ids_[directory_idx / DIRECTORY_ARRAY_SIZE];
+  auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(FetchPage(page_id)->GetData());
+  uint32_t local_depth = directory_page->GetLocalDepth(directory_idx % DIRECTORY_ARRAY_SIZE);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return local_depth;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor>
+void EXTENDIBLE_HASH_TABLE_TYPE::VisitDirectory(uint32_t first, uint32_t stride, Visitor &&visit) {
+  uint32_t size = 1U << global_depth_;
+  for (uint32_t i = first; i < size;) {
+    page_id_t page_id = directory_page_ids_[i / DIRECTORY_ARRAY_SIZE];
+    auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(FetchPage(page_id)->GetData());
+    bool dirty = false;
+    // the indexes in this page
+    uint32_t end = std::min(size, (i / DIRECTORY_ARRAY_SIZE + 1) * DIRECTORY_ARRAY_SIZE);
+    for (; i < end; i += stride) {
+      dirty = visit(directory_page, i % DIRECTORY_ARRAY_SIZE, i) || dirty;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, dirty);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::IncrGlobalDepth() {
+  assert(global_depth_ < HashTableDirectoryPage::MAX_GLOBAL_DEPTH);
+  uint32_t size = 1U << global_depth_;
+  if (size < DIRECTORY_ARRAY_SIZE) {
+    // the doubled directory still fits into the first page, whose new upper half refers to the same buckets
+    auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(FetchPage(directory_page_id_)->GetData());
+    directory_page->CopySlots(*directory_page, 0, size, size);
+    buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+  } else {
+    // the new upper half is a copy of every directory page
+    size_t num_pages = directory_page_ids_.size();
+    try {
+      for (size_t i = 0; i < num_pages; i++) {
+        page_id_t page_id;
+        Page *page = buffer_pool_manager_->NewPageInSegment(&page_id, &segment_);
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+        }
+        directory_page_ids_.push_back(page_id);
+        auto *copy = reinterpret_cast<HashTableDirectoryPage *>(page->GetData());
+        copy->SetPageId(page_id);
+        Page *original = buffer_pool_manager_->FetchPage(directory_page_ids_[i]);
+        if (original != nullptr) {
+          copy->CopySlots(*reinterpret_cast<HashTableDirectoryPage *>(original->GetData()), 0, 0, DIRECTORY_ARRAY_SIZE);
+          buffer_pool_manager_->UnpinPage(directory_page_ids_[i], false);
+        }
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        if (original == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+        }
+      }
+    } catch (Exception &e) {
+      // the directory stays as it was
+      while (directory_page_ids_.size() > num_pages) {
+        buffer_pool_manager_->DeletePage(directory_page_ids_.back());
+        directory_page_ids_.pop_back();
+      }
+      throw;
+    }
+  }
+  global_depth_++;
+  StoreDirectoryRoot();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::DecrGlobalDepth() {
+  assert(global_depth_ > 0);
+  global_depth_--;
+  // the pages that only held the dropped upper half go with it
+  size_t num_pages = std::max<size_t>((1U << global_depth_) / DIRECTORY_ARRAY_SIZE, 1);
+  while (directory_page_ids_.size() > num_pages) {
+    buffer_pool_manager_->DeletePage(directory_page_ids_.back());
+    directory_page_ids_.pop_back();
+  }
+  StoreDirectoryRoot();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::CanShrink() {
+  if (global_depth_ == 0) {
+    return false;
+  }
+  bool can_shrink = true;
+  VisitDirectory(0, 1, [&](HashTableDirectoryPage *directory_page, uint32_t slot, uint32_t directory_idx) {
+    can_shrink = can_shrink && directory_page->GetLocalDepth(slot) < global_depth_;
+    return false;
+  });
+  return can_shrink;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::StoreDirectoryRoot() {
+  auto *directory_page = reinterpret_cast<HashTableDirectoryPage *>(FetchPage(directory_page_id_)->GetData());
+  directory_page->SetGlobalDepth(global_depth_);
+  for (uint32_t i = 0; i < directory_page_ids_.size(); i++) {
+    directory_page->SetDirectoryPageId(i, directory_page_ids_[i]);
+  }
+  buffer_pool_manager_->UnpinPage(directory_page_id_, true);
+}
+
+/*****************************************************************************
+ * BUCKET CHAINS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::ChainGetValue(page_id_t bucket_page_id, const KeyType &key,
+                                               std::vector<ValueType> *result) {
+  bool found = false;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(page_id)->GetData());
+    found = bucket_page->GetValue(key, comparator_, result) || found;
+    page_id_t next_page_id = bucket_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::ChainInsert(page_id_t bucket_page_id, const KeyType &key, const ValueType &value,
+                                             bool *full) {
+  // the pair may be in any page of the bucket, so all of them are checked before it goes to the first one with room
+  *full = false;
+  page_id_t free_page_id = INVALID_PAGE_ID;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(page_id)->GetData());
+    bool exists = bucket_page->Contains(key, value, comparator_);
+    if (free_page_id == INVALID_PAGE_ID && !bucket_page->IsFull()) {
+      free_page_id = page_id;
+    }
+    page_id_t next_page_id = bucket_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    if (exists) {
+      return false;
+    }
+    page_id = next_page_id;
+  }
+  if (free_page_id == INVALID_PAGE_ID) {
+    *full = true;
+    return false;
+  }
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(free_page_id)->GetData());
+  bucket_page->Insert(key, value, comparator_);
+  buffer_pool_manager_->UnpinPage(free_page_id, true);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Predicate>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::ChainRemove(page_id_t bucket_page_id, Predicate &&remove) {
+  uint32_t num_removed = 0;
+  HASH_TABLE_BUCKET_TYPE *prev_page = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  bool prev_dirty = false;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      if (prev_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+    }
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    bool dirty = false;
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+      if (bucket_page->IsReadable(i) && remove(bucket_page->KeyAt(i), bucket_page->ValueAt(i))) {
+        bucket_page->RemoveAt(i);
+        num_removed++;
+        dirty = true;
+      }
+    }
+    page_id_t next_page_id = bucket_page->GetNextPageId();
+    if (prev_page != nullptr && bucket_page->IsEmpty()) {
+      // an emptied overflow page is unlinked from the bucket
+      prev_page->SetNextPageId(next_page_id);
+      prev_dirty = true;
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+    } else {
+      if (prev_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+      }
+      prev_page = bucket_page;
+      prev_page_id = page_id;
+      prev_dirty = dirty;
+    }
+    page_id = next_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(prev_page_id, prev_dirty);
+  return num_removed;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::CanSplit(page_id_t bucket_page_id, const KeyType &key) {
+  // the directory can tell hashes apart by their lowest MAX_GLOBAL_DEPTH bits only
+  const uint32_t mask = (1U << HashTableDirectoryPage::MAX_GLOBAL_DEPTH) - 1;
+  uint32_t hash = Hash(key) & mask;
+  bool can_split = false;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID && !can_split;) {
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(page_id)->GetData());
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE && !can_split; i++) {
+      can_split = bucket_page->IsReadable(i) && (Hash(bucket_page->KeyAt(i)) & mask) != hash;
+    }
+    page_id_t next_page_id = bucket_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return can_split;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::AppendOverflowPage(page_id_t bucket_page_id) {
+  page_id_t page_id = bucket_page_id;
+  while (true) {
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(page_id)->GetData());
+    page_id_t next_page_id = bucket_page->GetNextPageId();
+    if (next_page_id == INVALID_PAGE_ID) {
+      Page *overflow_page = buffer_pool_manager_->NewPageInSegment(&next_page_id, &segment_);
+      if (overflow_page == nullptr) {
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+      }
+      reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(overflow_page->GetData())->Init();
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+      bucket_page->SetNextPageId(next_page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+      return;
+    }
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::SplitBucket(uint32_t bucket_idx, page_id_t bucket_page_id) {
+  uint32_t local_depth = GetLocalDepth(bucket_idx);
+  uint32_t split_bit = 1U << local_depth;
+  auto moves = [&](const KeyType &key) { return (Hash(key) & split_bit) != 0; };
+
+  // the pairs whose hash has the split bit set go to the new bucket, which is filled before anything changes
+  std::vector<MappingType> moved;
+  for (page_id_t page_id = bucket_page_id; page_id != INVALID_PAGE_ID;) {
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(page_id)->GetData());
+    for (uint32_t i = 0; i < BUCKET_ARRAY_SIZE; i++) {
+      if (bucket_page->IsReadable(i) && moves(bucket_page->KeyAt(i))) {
+        moved.emplace_back(bucket_page->KeyAt(i), bucket_page->ValueAt(i));
+      }
+    }
+    page_id_t next_page_id = bucket_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  size_t num_pages = moved.empty() ? 1 : (moved.size() - 1) / BUCKET_ARRAY_SIZE + 1;
+  std::vector<page_id_t> new_page_ids(num_pages);
+  // the pages are allocated from the last one on, so that each one can link to the next
+  for (size_t i = num_pages; i-- > 0;) {
+    Page *page = buffer_pool_manager_->NewPageInSegment(&new_page_ids[i], &segment_);
+    if (page == nullptr) {
+      for (size_t j = i + 1; j < num_pages; j++) {
+        buffer_pool_manager_->DeletePage(new_page_ids[j]);
+      }
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "ExtendibleHashTable out of memory");
+    }
+    auto *new_bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+    new_bucket_page->Init();
+    new_bucket_page->SetNextPageId(i + 1 < num_pages ? new_page_ids[i + 1] : INVALID_PAGE_ID);
+    for (size_t j = i * BUCKET_ARRAY_SIZE; j < std::min(moved.size(), (i + 1) * BUCKET_ARRAY_SIZE); j++) {
+      new_bucket_page->Insert(moved[j].first, moved[j].second, comparator_);
+    }
+    buffer_pool_manager_->UnpinPage(new_page_ids[i], true);
+  }
+
+  // the indexes of the bucket agree in their lowest local_depth bits, the ones with the next bit set get the new
+  // bucket
+  VisitDirectory(bucket_idx & (split_bit - 1), split_bit,
+                 [&](HashTableDirectoryPage *directory_page, uint32_t slot, uint32_t directory_idx) {
+                   directory_page->SetLocalDepth(slot, local_depth + 1);
+                   if ((directory_idx & split_bit) != 0) {
+                     directory_page->SetBucketPageId(slot, new_page_ids[0]);
+                   }
+                   return true;
+                 });
+  ChainRemove(bucket_page_id, [&](const KeyType &key, const ValueType &value) { return moves(key); });
+}
+
+/*****************************************************************************
+ * SEARCH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key,
+                                          std::vector<ValueType> *result) {
+  table_latch_.RLock();
+  page_id_t bucket_page_id = GetBucketPageId(Hash(key) & ((1U << global_depth_) - 1));
+  Page *page = FetchPage(bucket_page_id);
+  // the latch of the first page of a bucket covers its overflow pages
+  page->RLatch();
+  bool found = ChainGetValue(bucket_page_id, key, result);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return found;
+}
+
+/*****************************************************************************
+ * INSERTION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  page_id_t bucket_page_id = GetBucketPageId(Hash(key) & ((1U << global_depth_) - 1));
+  Page *page = FetchPage(bucket_page_id);
+  page->WLatch();
+  bool full;
+  bool inserted = ChainInsert(bucket_page_id, key, value, &full);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+
+  if (full) {
+    return SplitInsert(transaction, key, value);
+  }
+  return inserted;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.WLock();
+  // the table latch keeps everyone else out, so the buckets are not latched
+  try {
+    while (true) {
+      uint32_t bucket_idx = Hash(key) & ((1U << global_depth_) - 1);
+      page_id_t bucket_page_id = GetBucketPageId(bucket_idx);
+      // another insert may have split the bucket while this one waited for the latch
+      bool full;
+      bool inserted = ChainInsert(bucket_page_id, key, value, &full);
+      if (!full) {
+        table_latch_.WUnlock();
+        return inserted;
+      }
+
+      // pairs whose hashes the directory can't tell apart, such as the pairs of a key with many values, stay in one
+      // bucket, which gets another page
+      if (!CanSplit(bucket_page_id, key)) {
+        AppendOverflowPage(bucket_page_id);
+        continue;
+      }
+      if (GetLocalDepth(bucket_idx) == global_depth_) {
+        IncrGlobalDepth();
+      }
+      SplitBucket(bucket_idx, bucket_page_id);
+    }
+  } catch (Exception &e) {
+    table_latch_.WUnlock();
+    throw;
+  }
+}
+
+/*****************************************************************************
+ * REMOVE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool EXTENDIBLE_HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
+  table_latch_.RLock();
+  page_id_t bucket_page_id = GetBucketPageId(Hash(key) & ((1U << global_depth_) - 1));
+  Page *page = FetchPage(bucket_page_id);
+  page->WLatch();
+  auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(page->GetData());
+  bool removed = ChainRemove(bucket_page_id, [&](const KeyType &pair_key, const ValueType &pair_value) {
+                   return pair_value == value && comparator_(pair_key, key) == 0;
+                 }) > 0;
+  bool empty = removed && bucket_page->IsEmpty() && bucket_page->GetNextPageId() == INVALID_PAGE_ID;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+
+  if (empty) {
+    Merge(transaction, key);
+  }
+  return removed;
+}
+
+/*****************************************************************************
+ * MERGE
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void EXTENDIBLE_HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key) {
+  table_latch_.WLock();
+  auto is_empty = [&](page_id_t page_id) {
+    auto *bucket_page = reinterpret_cast<HASH_TABLE_BUCKET_TYPE *>(FetchPage(page_id)->GetData());
+    bool empty = bucket_page->IsEmpty() && bucket_page->GetNextPageId() == INVALID_PAGE_ID;
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return empty;
+  };
+
+  // a bucket is merged with its split image if either one is empty and both have the same local depth; the merged
+  // bucket may then be merged with its own split image, up to the directory index of the key
+  try {
+    uint32_t bucket_idx = Hash(key) & ((1U << global_depth_) - 1);
+    for (uint32_t local_depth = GetLocalDepth(bucket_idx); local_depth > 0; local_depth--) {
+      uint32_t image_bit = 1U << (local_depth - 1);
+      uint32_t image_idx = bucket_idx ^ image_bit;
+      if (GetLocalDepth(image_idx) != local_depth) {
+        break;
+      }
+      page_id_t bucket_page_id = GetBucketPageId(bucket_idx);
+      page_id_t image_page_id = GetBucketPageId(image_idx);
+      bool bucket_empty = is_empty(bucket_page_id);
+      if (!bucket_empty && !is_empty(image_page_id)) {
+        break;
+      }
+
+      // the indexes of both buckets agree in their lowest local_depth - 1 bits
+      page_id_t kept_page_id = bucket_empty ? image_page_id : bucket_page_id;
+      VisitDirectory(bucket_idx & (image_bit - 1), image_bit,
+                     [&](HashTableDirectoryPage *directory_page, uint32_t slot, uint32_t directory_idx) {
+                       directory_page->SetBucketPageId(slot, kept_page_id);
+                       directory_page->SetLocalDepth(slot, local_depth - 1);
+                       return true;
+                     });
+      buffer_pool_manager_->DeletePage(bucket_empty ? bucket_page_id : image_page_id);
+    }
+    while (CanShrink()) {
+      DecrGlobalDepth();
+    }
+  } catch (Exception &e) {
+    table_latch_.WUnlock();
+    throw;
+  }
+  table_latch_.WUnlock();
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t EXTENDIBLE_HASH_TABLE_TYPE::GetGlobalDepth() {
+  table_latch_.RLock();
+  uint32_t global_depth = global_depth_;
+  table_latch_.RUnlock();
+  return global_depth;
+}
+
+template class ExtendibleHashTable<int, int, IntComparator>;
+
+template class ExtendibleHashTable<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTable<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,21 +27,183 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  Page *page = buffer_pool_manager_->NewPageInSegment(&header_page_id_, &segment_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "LinearProbeHashTable out of memory");
+  }
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(page->GetData());
+  header_page->SetPageId(header_page_id_);
+  header_page->SetNextPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
+  if (!AllocateBlocks(std::max<size_t>(num_buckets, 1), &block_page_ids_)) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "LinearProbeHashTable out of memory");
+  }
+  num_buckets_ = block_page_ids_.size() * BLOCK_ARRAY_SIZE;
+  StoreBlockPageIds();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "LinearProbeHashTable out of memory");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::AllocateBlocks(size_t num_buckets, std::vector<page_id_t> *block_page_ids) {
+  size_t num_blocks = (num_buckets - 1) / BLOCK_ARRAY_SIZE + 1;
+  for (size_t i = 0; i < num_blocks; i++) {
+    page_id_t page_id;
+    // new pages are zeroed, so all buckets of the block are unoccupied
+    if (buffer_pool_manager_->NewPageInSegment(&page_id, &segment_) == nullptr) {
+      DeleteBlocks(block_page_ids);
+      return false;
+    }
+    block_page_ids->push_back(page_id);
+    buffer_pool_manager_->UnpinPage(page_id, true);
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::DeleteBlocks(std::vector<page_id_t> *block_page_ids) {
+  for (page_id_t page_id : *block_page_ids) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  block_page_ids->clear();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::StoreBlockPageIds() {
+  page_id_t page_id = header_page_id_;
+  size_t index = 0;
+  while (page_id != INVALID_PAGE_ID) {
+    auto *header_page = reinterpret_cast<HashTableHeaderPage *>(FetchPage(page_id)->GetData());
+    header_page->SetSize(num_buckets_);
+    header_page->ClearBlockPageIds();
+    while (index < block_page_ids_.size() && header_page->NumBlocks() < HashTableHeaderPage::MaxNumBlocks()) {
+      header_page->AddBlockPageId(block_page_ids_[index++]);
+    }
+    // the chain only grows; header pages a smaller table doesn't need stay in it, empty
+    page_id_t next_page_id = header_page->GetNextPageId();
+    if (index < block_page_ids_.size() && next_page_id == INVALID_PAGE_ID) {
+      Page *next_page = buffer_pool_manager_->NewPageInSegment(&next_page_id, &segment_);
+      if (next_page == nullptr) {
+        buffer_pool_manager_->UnpinPage(page_id, true);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "LinearProbeHashTable out of memory");
+      }
+      auto *next_header_page = reinterpret_cast<HashTableHeaderPage *>(next_page->GetData());
+      next_header_page->SetPageId(next_page_id);
+      next_header_page->SetNextPageId(INVALID_PAGE_ID);
+      buffer_pool_manager_->UnpinPage(next_page_id, true);
+      header_page->SetNextPageId(next_page_id);
+    }
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    page_id = next_page_id;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename Visitor, typename EndVisitor>
+bool HASH_TABLE_TYPE::Probe(const KeyType &key, bool exclusive, Visitor &&visit, EndVisitor &&visit_end) {
+  uint64_t hash = hash_fn_.GetHash(key);
+  uint8_t fingerprint = HASH_TABLE_BLOCK_TYPE::Fingerprint(hash);
+  size_t bucket = hash % num_buckets_;
+  size_t num_blocks = block_page_ids_.size();
+  // the sequence ends in the block it started in, before the bucket it started at
+  for (size_t i = 0; i <= num_blocks; i++) {
+    slot_offset_t begin = i == 0 ? bucket % BLOCK_ARRAY_SIZE : 0;
+    slot_offset_t end = i == num_blocks ? bucket % BLOCK_ARRAY_SIZE : BLOCK_ARRAY_SIZE;
+    if (begin >= end) {
+      break;
+    }
+    Page *page = FetchPage(block_page_ids_[(bucket / BLOCK_ARRAY_SIZE + i) % num_blocks]);
+    exclusive ? page->WLatch() : page->RLatch();
+    auto *block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+
+    bool done = false;
+    slot_offset_t stop = block_page->ProbeFingerprints(begin, end, fingerprint, [&](slot_offset_t slot) {
+      done = visit(block_page, slot);
+      return done;
+    });
+    if (!done && stop < end) {
+      visit_end(block_page, stop, fingerprint);
+      done = true;
+    }
+
+    exclusive ? page->WUnlatch() : page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), done && exclusive);
+    if (done) {
+      return true;
+    }
+  }
+  return false;
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  table_latch_.RLock();
+  size_t size = result->size();
+  try {
+    Probe(
+        key, false,
+        [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t slot) {
+          if (comparator_(block_page->KeyAt(slot), key) == 0) {
+            result->push_back(block_page->ValueAt(slot));
+          }
+          return false;
+        },
+        [](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t slot, uint8_t fingerprint) {});
+  } catch (Exception &e) {
+    table_latch_.RUnlock();
+    throw;
+  }
+  table_latch_.RUnlock();
+  return result->size() > size;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  while (true) {
+    table_latch_.RLock();
+    bool inserted = false;
+    bool done;
+    // inserts take the first unoccupied bucket, so concurrent inserts of the same pair meet in the block that holds it
+    try {
+      done = Probe(
+          key, true,
+          [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t slot) {
+            return comparator_(block_page->KeyAt(slot), key) == 0 && block_page->ValueAt(slot) == value;
+          },
+          [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t slot, uint8_t fingerprint) {
+            inserted = block_page->Insert(slot, key, value, fingerprint);
+          });
+    } catch (Exception &e) {
+      table_latch_.RUnlock();
+      throw;
+    }
+    if (inserted) {
+      num_pairs_++;
+      num_occupied_++;
+    }
+    // probe sequences get long once most buckets are occupied, by pairs or tombstones
+    bool full = !done || num_occupied_ * 4 > num_buckets_ * 3;
+    table_latch_.RUnlock();
+    if (full) {
+      Resize(num_pairs_);
+    }
+    if (done) {
+      return inserted;
+    }
+  }
 }
 
 /*****************************************************************************
@@ -48,21 +211,105 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  table_latch_.RLock();
+  bool removed = false;
+  try {
+    Probe(
+        key, true,
+        [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t slot) {
+          removed = comparator_(block_page->KeyAt(slot), key) == 0 && block_page->ValueAt(slot) == value;
+          if (removed) {
+            block_page->Remove(slot);
+          }
+          return removed;
+        },
+        [](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t slot, uint8_t fingerprint) {});
+  } catch (Exception &e) {
+    table_latch_.RUnlock();
+    throw;
+  }
+  if (removed) {
+    num_pairs_--;
+  }
+  table_latch_.RUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  // the new table is at most half full, and has no tombstones; another insert may have resized the table already
+  size_t num_buckets = 2 * std::max<size_t>(initial_size, num_pairs_);
+  if (num_buckets_ >= num_buckets && num_occupied_ * 4 <= num_buckets_ * 3) {
+    table_latch_.WUnlock();
+    return;
+  }
+
+  // the new blocks are allocated before anything changes, so running out of memory leaves the table as it was
+  std::vector<page_id_t> old_block_page_ids;
+  if (!AllocateBlocks(num_buckets, &old_block_page_ids)) {
+    table_latch_.WUnlock();
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "LinearProbeHashTable out of memory");
+  }
+  std::swap(old_block_page_ids, block_page_ids_);
+  size_t old_num_buckets = std::exchange(num_buckets_, block_page_ids_.size() * BLOCK_ARRAY_SIZE);
+
+  Page *page = nullptr;
+  try {
+    for (page_id_t old_page_id : old_block_page_ids) {
+      page = FetchPage(old_page_id);
+      auto *block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+      for (slot_offset_t slot = 0; slot < BLOCK_ARRAY_SIZE; slot++) {
+        if (!block_page->IsReadable(slot)) {
+          continue;
+        }
+        KeyType key = block_page->KeyAt(slot);
+        ValueType value = block_page->ValueAt(slot);
+        // the pairs are unique, so they go to the end of their probe sequence without comparing keys
+        Probe(
+            key, true, [](HASH_TABLE_BLOCK_TYPE *new_block_page, slot_offset_t new_slot) { return false; },
+            [&](HASH_TABLE_BLOCK_TYPE *new_block_page, slot_offset_t new_slot, uint8_t fingerprint) {
+              new_block_page->Insert(new_slot, key, value, fingerprint);
+            });
+      }
+      buffer_pool_manager_->UnpinPage(old_page_id, false);
+      page = nullptr;
+    }
+  } catch (Exception &e) {
+    // the old blocks still hold all the pairs, so the table goes back to them
+    if (page != nullptr) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    }
+    DeleteBlocks(&block_page_ids_);
+    block_page_ids_ = std::move(old_block_page_ids);
+    num_buckets_ = old_num_buckets;
+    table_latch_.WUnlock();
+    throw;
+  }
+  DeleteBlocks(&old_block_page_ids);
+  num_occupied_ = num_pairs_.load();
+
+  try {
+    StoreBlockPageIds();
+  } catch (Exception &e) {
+    table_latch_.WUnlock();
+    throw;
+  }
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  size_t size = num_buckets_;
+  table_latch_.RUnlock();
+  return size;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
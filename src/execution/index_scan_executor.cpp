@@ -11,19 +11,129 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), plan_(plan) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      comparator_(exec_ctx->GetCatalog()->GetIndex(plan->GetIndexOid())->index_->GetKeySchema()) {
   auto index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
   index_ = dynamic_cast<IndexType *>(index_info->index_.get());
+  if (index_ == nullptr) {
+    throw Exception(ExceptionType::NOT_IMPLEMENTED, "IndexScanExecutor only scans B+ tree indexes");
+  }
   table_metadata_ = exec_ctx_->GetCatalog()->GetTable(index_info->table_name_);
   txn_ = exec_ctx_->GetTransaction();
 }
 
-void IndexScanExecutor::Init() { iter_ = std::make_unique<IndexIteratorType>(index_->GetBeginIterator()); }
+void IndexScanExecutor::Init() {
+  lower_key_.reset();
+  upper_key_.reset();
+  if (index_->GetKeyAttrs().size() == 1 && index_->IsUnique()) {
+    DeriveBounds(plan_->GetPredicate());
+  }
+
+  if (plan_->IsDescending()) {
+    iter_ = std::make_unique<IndexIteratorType>(upper_key_.has_value() ? index_->GetReverseBeginIterator(*upper_key_)
+                                                                       : index_->GetReverseBeginIterator());
+  } else {
+    iter_ = std::make_unique<IndexIteratorType>(lower_key_.has_value() ? index_->GetBeginIterator(*lower_key_)
+                                                                       : index_->GetBeginIterator());
+  }
+}
+
+void IndexScanExecutor::DeriveBounds(const AbstractExpression *expr) {
+  if (const auto *logic = dynamic_cast<const LogicExpression *>(expr); logic != nullptr) {
+    // a bound of either side of a disjunction doesn't hold for the other side
+    if (logic->GetLogicType() == LogicType::And) {
+      DeriveBounds(logic->GetChildAt(0));
+      DeriveBounds(logic->GetChildAt(1));
+    }
+    return;
+  }
+  const auto *comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr) {
+    return;
+  }
+
+  // the comparison must be between the key column and a constant, the constant goes to the right
+  auto type = comparison->GetComparisonType();
+  const auto *column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  const auto *constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+  if (column == nullptr || constant == nullptr) {
+    column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+    constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+    switch (type) {
+      case ComparisonType::LessThan:
+        type = ComparisonType::GreaterThan;
+        break;
+      case ComparisonType::LessThanOrEqual:
+        type = ComparisonType::GreaterThanOrEqual;
+        break;
+      case ComparisonType::GreaterThan:
+        type = ComparisonType::LessThan;
+        break;
+      case ComparisonType::GreaterThanOrEqual:
+        type = ComparisonType::LessThanOrEqual;
+        break;
+      default:
+        break;
+    }
+  }
+  if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0 ||
+      column->GetColIdx() != index_->GetKeyAttrs()[0] || type == ComparisonType::NotEqual) {
+    return;
+  }
+
+  // the key is built from the constant like the index keys are from the column values, so the constant is converted to
+  // the column type; a conversion that rounds the constant would make the bound too tight, so only exact ones are used
+  Value value = constant->Evaluate(nullptr, nullptr);
+  TypeId key_type = table_metadata_->schema_.GetColumn(column->GetColIdx()).GetType();
+  auto is_integer = [](TypeId type_id) {
+    return type_id == TypeId::TINYINT || type_id == TypeId::SMALLINT || type_id == TypeId::INTEGER ||
+           type_id == TypeId::BIGINT;
+  };
+  if (value.IsNull() || (value.GetTypeId() != key_type && !(is_integer(value.GetTypeId()) && is_integer(key_type)))) {
+    return;
+  }
+  GenericKey<8> key;
+  try {
+    key.SetFromKey(Tuple({value.CastAs(key_type)}, index_->GetKeySchema()), index_->GetKeySchema());
+  } catch (const Exception &e) {
+    // the constant is out of the range of the key column
+    return;
+  }
+
+  // the bounds are inclusive, the predicate filters out the key of a strict comparison
+  if (type != ComparisonType::LessThan && type != ComparisonType::LessThanOrEqual &&
+      (!lower_key_.has_value() || comparator_(key, *lower_key_) > 0)) {
+    lower_key_ = key;
+  }
+  if (type != ComparisonType::GreaterThan && type != ComparisonType::GreaterThanOrEqual &&
+      (!upper_key_.has_value() || comparator_(key, *upper_key_) < 0)) {
+    upper_key_ = key;
+  }
+}
+
+bool IndexScanExecutor::IsPastEnd(const GenericKey<8> &key) const {
+  if (plan_->IsDescending()) {
+    return lower_key_.has_value() && comparator_(key, *lower_key_) < 0;
+  }
+  return upper_key_.has_value() && comparator_(key, *upper_key_) > 0;
+}
 
 bool IndexScanExecutor::Next(Tuple *tuple, RID *rid) {
   while (!iter_->isEnd()) {
+    if (IsPastEnd((**iter_).first)) {
+      // release the leaf right away instead of when the executor is destroyed
+      iter_ = std::make_unique<IndexIteratorType>(index_->GetEndIterator());
+      return false;
+    }
     *rid = (**iter_).second;
 
     if (auto level = txn_->GetIsolationLevel();
@@ -31,37 +31,62 @@ NestIndexJoinExecutor::NestIndexJoinExecutor(ExecutorContext *exec_ctx, const Ne
   BUSTUB_ASSERT(right_col_value_expr_->GetColIdx() == key_attrs[0] && key_attrs.size() == 1, "");
 }
 
-void NestIndexJoinExecutor::Init() { child_executor_->Init(); }
+void NestIndexJoinExecutor::Init() {
+  child_executor_->Init();
+  outer_tuples_.clear();
+  inner_rids_.clear();
+  next_outer_tuple_ = 0;
+  next_inner_rid_ = 0;
+}
 
-bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+bool NestIndexJoinExecutor::NextBatch() {
+  outer_tuples_.clear();
   Tuple outer_tuple;
   RID outer_rid;
+  while (outer_tuples_.size() < static_cast<size_t>(INDEX_JOIN_BATCH_SIZE) &&
+         child_executor_->Next(&outer_tuple, &outer_rid)) {
+    outer_tuples_.push_back(outer_tuple);
+  }
+  if (outer_tuples_.empty()) {
+    return false;
+  }
 
-  while (child_executor_->Next(&outer_tuple, &outer_rid)) {
-    std::vector<Value> key_values(1);
-    key_values[0] = left_col_value_expr_->Evaluate(&outer_tuple, plan_->OuterTableSchema());
-    Tuple key_tuple(key_values, &inner_index_info_->key_schema_);
-
-    std::vector<RID> rids;
-    inner_index_info_->index_->ScanKey(key_tuple, &rids, exec_ctx_->GetTransaction());
+  std::vector<Tuple> key_tuples;
+  key_tuples.reserve(outer_tuples_.size());
+  for (const auto &tuple : outer_tuples_) {
+    std::vector<Value> key_values{left_col_value_expr_->Evaluate(&tuple, plan_->OuterTableSchema())};
+    key_tuples.emplace_back(key_values, &inner_index_info_->key_schema_);
+  }
+  inner_index_info_->index_->ScanKeys(key_tuples, &inner_rids_, exec_ctx_->GetTransaction());
+  next_outer_tuple_ = 0;
+  next_inner_rid_ = 0;
+  return true;
+}
 
-    if (!rids.empty()) {
-      BUSTUB_ASSERT(rids.size() == 1, "");
-      Tuple inner_tuple;
-      inner_table_metadata_->table_->GetTuple(rids[0], &inner_tuple, exec_ctx_->GetTransaction());
+bool NestIndexJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  // skip the outer tuples without a match, and the ones whose matches have all been joined
+  while (next_outer_tuple_ == outer_tuples_.size() || next_inner_rid_ == inner_rids_[next_outer_tuple_].size()) {
+    if (next_outer_tuple_ < outer_tuples_.size()) {
+      next_outer_tuple_++;
+      next_inner_rid_ = 0;
+    } else if (!NextBatch()) {
+      return false;
+    }
+  }
 
-      std::vector<Value> values;
-      for (size_t i = 0; i < GetOutputSchema()->GetColumnCount(); i++) {
-        auto expr = GetOutputSchema()->GetColumn(i).GetExpr();
-        values.push_back(
-            expr->EvaluateJoin(&outer_tuple, plan_->OuterTableSchema(), &inner_tuple, plan_->InnerTableSchema()));
-      }
-      *tuple = Tuple(values, GetOutputSchema());
+  const Tuple &outer_tuple = outer_tuples_[next_outer_tuple_];
+  Tuple inner_tuple;
+  inner_table_metadata_->table_->GetTuple(inner_rids_[next_outer_tuple_][next_inner_rid_++], &inner_tuple,
+                                          exec_ctx_->GetTransaction());
 
-      return true;
-    }
+  std::vector<Value> values;
+  for (size_t i = 0; i < GetOutputSchema()->GetColumnCount(); i++) {
+    auto expr = GetOutputSchema()->GetColumn(i).GetExpr();
+    values.push_back(
+        expr->EvaluateJoin(&outer_tuple, plan_->OuterTableSchema(), &inner_tuple, plan_->InnerTableSchema()));
   }
-  return false;
+  *tuple = Tuple(values, GetOutputSchema());
+  return true;
 }
 
 }  // namespace bustub
@@ -16,14 +16,14 @@
 namespace bustub {
 
 SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx), plan_(plan) {
+    : AbstractExecutor(exec_ctx), plan_(plan), strategy_(std::make_unique<BufferAccessStrategy>()) {
   auto oid = plan_->GetTableOid();
   table_metadata_ = exec_ctx_->GetCatalog()->GetTable(oid);
   txn_ = exec_ctx_->GetTransaction();
 }
 
 void SeqScanExecutor::Init() {
-  iter_ = std::make_unique<TableIterator>(table_metadata_->table_->Begin(exec_ctx_->GetTransaction()));
+  iter_ = std::make_unique<TableIterator>(table_metadata_->table_->Begin(txn_, strategy_.get()));
 }
 
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
@@ -0,0 +1,109 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <mutex>               // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+class BufferPoolManager;
+
+/**
+ * BufferAccessStrategy lets a bulk operation such as a sequential scan read pages through a small private ring of
+ * frames. When a page fetched with the strategy is not in the buffer pool, the frame the scan used ring_size misses
+ * ago is recycled for it, provided that nobody has the frame pinned. Only when that is not possible is a victim
+ * taken from the shared replacer, and that frame then joins the ring. A full-table scan therefore keeps replacing
+ * its own pages instead of evicting the working set of the rest of the system.
+ *
+ * A strategy belongs to a single scan, but the pages the scan prefetches are read with it from the buffer pool's
+ * prefetch thread too. It keeps one ring per buffer pool instance it reads from, and it is only destroyed once the
+ * prefetches issued with it have finished.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param ring_size the number of frames the scan may recycle in each buffer pool instance
+   */
+  explicit BufferAccessStrategy(size_t ring_size = SCAN_RING_SIZE) : ring_size_(ring_size) {
+    BUSTUB_ASSERT(ring_size_ >= 2, "The ring must hold at least the current and the next page of a scan.");
+  }
+
+  /**
+   * Destroys the strategy, waiting for the prefetches that still refer to it.
+   */
+  ~BufferAccessStrategy() {
+    std::unique_lock<std::mutex> guard(latch_);
+    cv_.wait(guard, [&] { return num_pending_prefetches_ == 0; });
+  }
+
+  DISALLOW_COPY(BufferAccessStrategy);
+
+  /** @return the number of frames the scan may recycle in each buffer pool instance */
+  size_t GetRingSize() const { return ring_size_; }
+
+ private:
+  /** A frame of the ring, together with the page the scan read into it. */
+  struct RingSlot {
+    frame_id_t frame_id_;
+    page_id_t page_id_;
+  };
+
+  /** The ring of one buffer pool instance. */
+  struct Ring {
+    std::vector<RingSlot> slots_;
+    /** The slot to be recycled by the next miss. */
+    size_t next_{0};
+  };
+
+  /**
+   * The ring of a buffer pool instance. Its slots are only accessed while holding the latch of that instance.
+   * @param bpm the buffer pool instance
+   * @return the ring of the instance, created empty on first use
+   */
+  Ring *GetRing(const BufferPoolManager *bpm) {
+    std::scoped_lock guard(latch_);
+    return &rings_[bpm];
+  }
+
+  /** Note a prefetch issued with this strategy. */
+  void BeginPrefetch() {
+    std::scoped_lock guard(latch_);
+    num_pending_prefetches_++;
+  }
+
+  /** Note that a prefetch issued with this strategy has finished or was dropped. */
+  void EndPrefetch() {
+    std::scoped_lock guard(latch_);
+    if (--num_pending_prefetches_ == 0) {
+      cv_.notify_all();
+    }
+  }
+
+  size_t ring_size_;
+  /** Protects rings_ (but not the rings themselves) and num_pending_prefetches_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::unordered_map<const BufferPoolManager *, Ring> rings_;
+  size_t num_pending_prefetches_{0};
+};
+
+}  // namespace bustub
@@ -12,13 +12,25 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+#include "storage/disk/segment.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -27,6 +39,8 @@ namespace bustub {
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
 class BufferPoolManager {
+  friend class ParallelBufferPoolManager;
+
  public:
   enum class CallbackType { BEFORE, AFTER };
   using bufferpool_callback_fn = void (*)(enum CallbackType, const page_id_t page_id);
@@ -36,13 +50,16 @@ class BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used to pick victim frames
+   * @param disk_scheduler the scheduler page I/O is submitted to, nullptr to create one for this buffer pool
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRU, DiskScheduler *disk_scheduler = nullptr);
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -52,6 +69,56 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Fetch the requested page on behalf of a bulk operation. If the page is not in the buffer pool, it is read into a
+   * frame recycled from the strategy's ring whenever possible.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy of the operation, nullptr to fetch the page like FetchPage does
+   * @return the requested page
+   */
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+    return FetchPageWithStrategyImpl(page_id, strategy);
+  }
+
+  /**
+   * Find a page in the buffer pool for an optimistic read, without taking the buffer pool latch or touching the
+   * replacer. The page gets a light pin that only keeps its frame from being given to another page; writers may still
+   * change it, so whatever is read from it is only valid if page->ValidateVersion(*version) holds afterwards. Evicting
+   * the frame waits for the pin, so it has to be dropped with UnpinPageOptimistic before the thread fetches, unpins or
+   * latches any other page.
+   * @param page_id id of the page
+   * @param[out] version the version of the page, never odd
+   * @return the page, nullptr if it is not in the buffer pool, is write latched or could not be found without latch_
+   */
+  Page *FetchPageOptimistic(page_id_t page_id, uint64_t *version) { return FetchPageOptimisticImpl(page_id, version); }
+
+  /**
+   * Drop the pin taken by FetchPageOptimistic. The version of the page can still be validated afterwards, it changes
+   * whenever the frame is given to another page.
+   * @param page the page returned by FetchPageOptimistic
+   */
+  void UnpinPageOptimistic(Page *page) { page->optimistic_pins_.fetch_sub(1, std::memory_order_release); }
+
+  /**
+   * Start loading a page into the buffer pool without waiting for it. A background thread reads the page into an
+   * unpinned frame, so that a later FetchPage finds it in the pool. This is only a hint: pages that are already in
+   * the pool are skipped, and the request may be dropped if too many are queued.
+   * @param page_id id of the page to load
+   * @param strategy the buffer access strategy the page is read with, nullptr for none
+   */
+  void PrefetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) {
+    PrefetchPagesImpl({page_id}, strategy);
+  }
+
+  /**
+   * Start loading several pages into the buffer pool without waiting for them. See PrefetchPage.
+   * @param page_ids ids of the pages to load, in the order they should be read
+   * @param strategy the buffer access strategy the pages are read with, nullptr for none
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) {
+    PrefetchPagesImpl(page_ids, strategy);
+  }
+
   /** Grading function. Do not modify! */
   bool UnpinPage(page_id_t page_id, bool is_dirty, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -76,6 +143,15 @@ class BufferPoolManager {
     return result;
   }
 
+  /**
+   * Create a new page whose id is allocated from a segment instead of the disk manager, so that the pages created in
+   * the same segment lie next to each other on disk.
+   * @param[out] page_id id of created page
+   * @param segment the segment the page belongs to, nullptr to allocate the page id like NewPage does
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageInSegment(page_id_t *page_id, Segment *segment) { return NewPageInSegmentImpl(page_id, segment); }
+
   /** Grading function. Do not modify! */
   bool DeletePage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
     GradingCallback(callback, CallbackType::BEFORE, page_id);
@@ -95,7 +171,28 @@ class BufferPoolManager {
   Page *GetPages() { return pages_; }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /**
+   * Start the background page cleaner. Every interval it writes up to max_pages dirty, unpinned pages to disk in
+   * page id order and marks them clean, so that the replacer mostly finds clean victims and foreground operations do
+   * not have to write pages back themselves. Does nothing if the cleaner is already running.
+   * @param interval the time between two rounds of the cleaner
+   * @param max_pages the maximum number of pages written in one round
+   */
+  virtual void StartPageCleaner(std::chrono::milliseconds interval = page_cleaner_interval,
+                                size_t max_pages = PAGE_CLEANER_MAX_PAGES);
+
+  /**
+   * Stop and join the background page cleaner. Does nothing if the cleaner is not running.
+   */
+  virtual void StopPageCleaner();
+
+  /** @return the number of dirty pages written back by foreground operations when their frame was reused */
+  virtual size_t GetForegroundFlushCount() { return foreground_flush_count_; }
+
+  /** @return the number of dirty pages written by the background page cleaner */
+  virtual size_t GetBackgroundFlushCount() { return background_flush_count_; }
 
  protected:
   /**
@@ -114,9 +211,32 @@ class BufferPoolManager {
   /**
    * Fetch the requested page from the buffer pool.
    * @param page_id id of page to be fetched
-   * @return the requested page
+   * @return the requested page, nullptr if every frame is pinned or the page could not be read
+   */
+  virtual Page *FetchPageImpl(page_id_t page_id);
+
+  /**
+   * Fetch the requested page from the buffer pool, taking the frame for a miss from the strategy's ring if possible.
+   * @param page_id id of page to be fetched
+   * @param strategy the buffer access strategy, or nullptr
+   * @return the requested page, nullptr if every frame is pinned or the page could not be read
+   */
+  virtual Page *FetchPageWithStrategyImpl(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /**
+   * Find a page in the buffer pool for an optimistic read, see FetchPageOptimistic.
+   * @param page_id id of the page
+   * @param[out] version the version of the page
+   * @return the page with an optimistic pin, or nullptr
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageOptimisticImpl(page_id_t page_id, uint64_t *version);
+
+  /**
+   * Queue pages to be read by the prefetch thread, starting the thread if it is not running yet.
+   * @param page_ids ids of the pages to load
+   * @param strategy the buffer access strategy the pages are read with, or nullptr
+   */
+  virtual void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -124,33 +244,57 @@ class BufferPoolManager {
    * @param is_dirty true if the page should be marked as dirty, false otherwise
    * @return false if the page pin count is <= 0 before this call, true otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
 
   /**
-   * Flushes the target page to disk.
+   * Flushes the target page to disk. The write is not synced, see DiskManager::SyncDatabase.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
-   * @return false if the page could not be found in the page table, true otherwise
+   * @return false if the page could not be found in the page table or could not be written, true otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id);
 
   /**
    * Creates a new page in the buffer pool.
    * @param[out] page_id id of created page
    * @return nullptr if no new pages could be created, otherwise pointer to new page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id);
+
+  /**
+   * Creates a new page in the buffer pool, allocating its id from a segment.
+   * @param[out] page_id id of created page
+   * @param segment the segment the page belongs to, nullptr to allocate the page id from the disk manager
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageInSegmentImpl(page_id_t *page_id, Segment *segment);
 
   /**
    * Deletes a page from the buffer pool.
    * @param page_id id of page to be deleted
    * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id);
+
+  /**
+   * Flushes all the pages in the buffer pool to disk and syncs the database file, making them durable.
+   */
+  virtual void FlushAllPagesImpl();
+
+  /**
+   * Creates a new page in the buffer pool for a page id that has already been allocated on disk.
+   * @param page_id id of the page to create
+   * @return nullptr if no frame is available, otherwise pointer to new page
+   */
+  Page *InstallNewPage(page_id_t page_id);
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Allocate the id of a new page.
+   * @param segment the segment the page belongs to, nullptr if it belongs to none
+   * @return the id of the page
    */
-  void FlushAllPagesImpl();
+  page_id_t AllocatePage(Segment *segment) {
+    return segment == nullptr ? disk_manager_->AllocatePage() : segment->AllocatePage(disk_manager_);
+  }
 
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
@@ -160,16 +304,194 @@ class BufferPoolManager {
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
+  /** Pointer to the disk scheduler all page I/O is submitted to. */
+  DiskScheduler *disk_scheduler_;
+  /** The disk scheduler, if this buffer pool created its own. */
+  std::unique_ptr<DiskScheduler> owned_disk_scheduler_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /**
+   * The frame each page was last put in, in one of the two entries FrameHint gives for the page, so that
+   * FetchPageOptimistic can find pages without latch_. Entries are never cleared, the page id of the frame is checked
+   * instead.
+   */
+  std::unique_ptr<std::atomic<frame_id_t>[]> frame_hints_;
+  /** Number of entries in frame_hints_. */
+  size_t num_frame_hints_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects free_list/page_table and the process of pin/unpin pages. */
+  /** This latch protects free_list/page_table and the process of pin/unpin pages. It is never held across disk I/O. */
   std::mutex latch_;
+  /** Signalled whenever a frame finishes its disk I/O. Used together with latch_. */
+  std::condition_variable io_cv_;
+  /** Pages evicted from the pool whose write-back is still in flight. They must not be read back until it is done. */
+  std::unordered_set<page_id_t> writing_pages_;
+  /** Pages the page cleaner is writing. A newer image of them must not be written, nor an older one read, meanwhile. */
+  std::unordered_set<page_id_t> cleaning_pages_;
+  /** Number of dirty victims written back by foreground operations. */
+  std::atomic<size_t> foreground_flush_count_{0};
+  /** Number of pages written by the page cleaner. */
+  std::atomic<size_t> background_flush_count_{0};
 
  private:
-  void InternalFlushPage(frame_id_t frame_id, bool force);
+  /**
+   * Find a frame to hold a new page, taking it from the free list first and the replacer second.
+   * The victim is removed from the page table but its write-back is left to the caller, so that it can happen
+   * without holding latch_. Must be called with latch_ held.
+   * @param[out] frame_id the frame that was found
+   * @param[out] evicted_page_id the dirty page that has to be written back before the frame is reused,
+   *             INVALID_PAGE_ID if there is none
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindFreeFrame(frame_id_t *frame_id, page_id_t *evicted_page_id);
+
+  /**
+   * Recycle the next frame of the strategy's ring in this instance, if it still holds the unpinned page the scan
+   * read into it. Like FindFreeFrame, the write-back of the evicted page is left to the caller. Must be called with
+   * latch_ held.
+   * @param strategy the buffer access strategy
+   * @param[out] frame_id the frame that was recycled
+   * @param[out] evicted_page_id the dirty page that has to be written back before the frame is reused,
+   *             INVALID_PAGE_ID if there is none
+   * @return false if the ring slot is not filled yet or its frame cannot be recycled, true otherwise
+   */
+  bool FindRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id, page_id_t *evicted_page_id);
+
+  /**
+   * Remember that the scan read a page into a frame, in the ring slot that is recycled next, and advance the ring.
+   * Must be called with latch_ held.
+   * @param strategy the buffer access strategy
+   * @param frame_id the frame the page was read into
+   * @param page_id the page read by the scan
+   */
+  void AdvanceRing(BufferAccessStrategy *strategy, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * Make the frame hold a new, zeroed page and pin it. If a dirty page was evicted from the frame, it is written back
+   * with latch_ released; other threads fetching the new page wait until the frame is ready. A stale image of a
+   * deleted page with the same (reused) id is dropped first.
+   * @param frame_id the frame returned by FindFreeFrame
+   * @param page_id id of the new page
+   * @param evicted_page_id the evicted page returned by FindFreeFrame
+   * @param guard the held lock on latch_
+   * @return pointer to the new page
+   */
+  Page *NewPageInFrame(frame_id_t frame_id, page_id_t page_id, page_id_t evicted_page_id,
+                       std::unique_lock<std::mutex> *guard);
+
+  /**
+   * @param page_id id of a page
+   * @param choice 0 or 1, a page has two entries to choose from
+   * @return an entry of frame_hints_ for the page
+   */
+  std::atomic<frame_id_t> &FrameHint(page_id_t page_id, int choice) {
+    return frame_hints_[static_cast<uint32_t>(page_id) * (choice == 0 ? 2654435761U : 2246822519U) %
+                        num_frame_hints_];
+  }
+
+  /**
+   * Point an entry of frame_hints_ at the frame of a page, preferring an entry that no other page in the buffer pool
+   * needs. Must be called with latch_ held.
+   * @param page_id id of the page
+   * @param frame_id the frame of the page
+   */
+  void SetFrameHint(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Start giving a frame to another page: make its version odd, so that no optimistic reader gets the frame anymore,
+   * and wait for the readers that still have it. Must be called with latch_ held, before the page id or the data of
+   * the frame change.
+   * @param page the page of the frame
+   */
+  void BeginFrameReuse(Page *page);
+
+  /**
+   * Finish giving a frame to another page, once its new page id and data are in place.
+   * @param page the page of the frame
+   */
+  void EndFrameReuse(Page *page);
+
+  /**
+   * Give up on the page an operation put into a frame because its I/O failed, and drop the operation's pin. If the
+   * write-back of the evicted page failed, that page stays in the frame, dirty; otherwise the frame is left empty.
+   * Must be called with latch_ held, before FinishFrameIO.
+   * @param frame_id the frame
+   * @param page_id the page that was to be put into the frame
+   * @param evicted_page_id the evicted page to keep in the frame, INVALID_PAGE_ID if there is none
+   */
+  void AbandonFrame(frame_id_t frame_id, page_id_t page_id, page_id_t evicted_page_id);
+
+  /**
+   * Drop a pin on a frame, returning the frame to the replacer, or to the free list if it holds no page, when it was
+   * the last one. Must be called with latch_ held.
+   * @param frame_id the frame
+   */
+  void ReleaseFramePin(frame_id_t frame_id);
+
+  /**
+   * Mark the disk I/O on a frame as finished, which also ends the reuse of the frame, and wake up the threads waiting
+   * for it. Must be called with latch_ held.
+   * @param frame_id the frame whose I/O finished
+   * @param evicted_page_id the page that was written back from this frame, INVALID_PAGE_ID if there is none
+   */
+  void FinishFrameIO(frame_id_t frame_id, page_id_t evicted_page_id);
+
+  /**
+   * Write a page back to disk without holding latch_ during the write. The page stays pinned meanwhile.
+   * @param page_id id of the page to write
+   * @param force write the page even if it is not dirty
+   * @return false if the page is not in the buffer pool, true otherwise
+   */
+  bool InternalFlushPage(page_id_t page_id, bool force);
+
+  /**
+   * Write every page in the buffer pool to disk, without syncing the database file.
+   */
+  void WriteBackAllPages();
+
+  /**
+   * Body of the page cleaner thread. Each round copies the selected pages under latch_, marks them clean and writes
+   * the copies without holding latch_, so that the frames stay available to the replacer and to readers. A page whose
+   * write fails is marked dirty again; until the write is done, evicting the page writes it back as if it was dirty.
+   */
+  void RunPageCleaner();
+
+  /**
+   * Stop and join the prefetch thread, dropping the requests that are still queued.
+   */
+  void StopPrefetcher();
+
+  /**
+   * Body of the prefetch thread. Each request is served like a FetchPage followed by an UnpinPage.
+   */
+  void RunPrefetcher();
+
+  /** A page to be read by the prefetch thread. */
+  struct PrefetchRequest {
+    page_id_t page_id_;
+    BufferAccessStrategy *strategy_;
+  };
+
+  /** Pending prefetches, in the order they are served. Protected by latch_. */
+  std::deque<PrefetchRequest> prefetch_queue_;
+  /** Pages that are queued or being read by the prefetch thread. Protected by latch_. */
+  std::unordered_set<page_id_t> prefetching_pages_;
+  /** The prefetch thread, nullptr until the first prefetch. */
+  std::thread *prefetch_thread_{nullptr};
+  /** Whether the prefetch thread should keep running. Protected by latch_. */
+  bool enable_prefetcher_{true};
+  /** Wakes up the prefetch thread when a request is queued or it is stopped. Used together with latch_. */
+  std::condition_variable prefetch_cv_;
+
+  /** The page cleaner thread, nullptr if it is not running. */
+  std::thread *page_cleaner_thread_{nullptr};
+  /** Whether the page cleaner should keep running. Protected by latch_. */
+  bool enable_page_cleaner_{false};
+  /** Wakes up the page cleaner when it is stopped. Used together with latch_. */
+  std::condition_variable page_cleaner_cv_;
+  std::chrono::milliseconds page_cleaner_interval_{0};
+  size_t page_cleaner_max_pages_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The replacer remembers the timestamps of the last K uncorrelated accesses of every frame. The backward K-distance
+ * of a frame is the difference between the current timestamp and the timestamp of its K-th most recent access, and
+ * the evictable frame with the largest backward K-distance is victimized. Frames with fewer than K recorded accesses
+ * have an infinite backward K-distance; among them the one with the earliest recorded access is evicted first.
+ *
+ * Accesses that follow the previous access of the same frame within the correlated reference period are considered
+ * correlated (e.g. the same transaction touching a page several times) and are folded into that previous access
+ * instead of being recorded separately. Frames that are still inside their correlated reference period are only
+ * evicted if no other frame is evictable. Timestamps are logical: every recorded access advances the clock by one.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k the number of accesses remembered per frame
+   * @param correlated_reference_period accesses less than this many ticks after the previous access of the same
+   *        frame are correlated with it
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K,
+                        size_t correlated_reference_period = LRUK_CORRELATED_REFERENCE_PERIOD);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  /** Ordering key of an evictable frame: the oldest remembered timestamp, then the frame id. */
+  using FrameKey = std::pair<size_t, frame_id_t>;
+
+  struct FrameRecord {
+    /** Timestamps of the last (at most K) uncorrelated accesses, oldest first. */
+    std::deque<size_t> history_;
+    /** Timestamp of the last access, correlated or not. */
+    size_t last_access_{0};
+    bool evictable_{false};
+  };
+
+  /** @return the set the frame is ordered in while it is evictable */
+  std::set<FrameKey> *FrameSet(const FrameRecord &record);
+
+  void InternalRecordAccess(frame_id_t frame_id);
+
+  void InternalErase(frame_id_t frame_id);
+
+  std::mutex latch_;
+  size_t k_;
+  size_t correlated_reference_period_;
+  size_t current_timestamp_{0};
+  std::vector<FrameRecord> records_;
+  /** Evictable frames with fewer than K remembered accesses, i.e. an infinite backward K-distance. */
+  std::set<FrameKey> young_frames_;
+  /** Evictable frames with K remembered accesses; the first one has the largest backward K-distance. */
+  std::set<FrameKey> old_frames_;
+};
+
+}  // namespace bustub
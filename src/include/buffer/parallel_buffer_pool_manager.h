@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool into several independent BufferPoolManager instances, each with
+ * its own page table, free list, replacer and latch. A page always lives in the instance selected by hashing its
+ * page id, so operations on pages of different instances never contend on the same latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual buffer pool instances
+   * @param pool_size the size of each buffer pool instance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy used by every instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, i.e. the total number of frames over all instances */
+  size_t GetPoolSize() override { return num_instances_ * instance_pool_size_; }
+
+  /** @return the number of buffer pool instances */
+  size_t GetNumInstances() const { return num_instances_; }
+
+  /** Start the page cleaner of every instance. */
+  void StartPageCleaner(std::chrono::milliseconds interval = page_cleaner_interval,
+                        size_t max_pages = PAGE_CLEANER_MAX_PAGES) override;
+
+  /** Stop the page cleaner of every instance. */
+  void StopPageCleaner() override;
+
+  /** @return the number of dirty pages written back by foreground operations, summed over all instances */
+  size_t GetForegroundFlushCount() override;
+
+  /** @return the number of dirty pages written by the page cleaners, summed over all instances */
+  size_t GetBackgroundFlushCount() override;
+
+ protected:
+  /**
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManager instance responsible for handling given page id
+   */
+  BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
+
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  Page *FetchPageWithStrategyImpl(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  Page *FetchPageOptimisticImpl(page_id_t page_id, uint64_t *version) override;
+
+  void PrefetchPagesImpl(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Creates a new page. A page id is allocated from the segment or the disk manager first and the page is then created
+   * in the instance that owns that id. If that instance has no free frame, another page id is tried, until every
+   * instance has been asked once. Page ids that could not be used are given back to the disk manager.
+   * @param[out] page_id id of created page
+   * @param segment the segment the page belongs to, nullptr to allocate the page id from the disk manager
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPageInSegmentImpl(page_id_t *page_id, Segment *segment) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** Number of buffer pool instances. */
+  size_t num_instances_;
+  /** Number of pages in each buffer pool instance. */
+  size_t instance_pool_size_;
+  /** The buffer pool instances. */
+  std::vector<std::unique_ptr<BufferPoolManager>> instances_;
+};
+
+}  // namespace bustub
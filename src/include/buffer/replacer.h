@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManager can be constructed with. */
+enum class ReplacerType { LRU, CLOCK, LRU_K };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -43,6 +46,20 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Records that the page held by a frame has been accessed. Called on every fetch of the page, not only when the
+   * frame becomes pinned. Policies that only look at pin/unpin events can ignore it.
+   * @param frame_id the id of the accessed frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id) {}
+
+  /**
+   * Removes a frame from the replacer because the page it held has been deleted. Any state the policy kept for the
+   * frame is dropped.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -9,7 +9,9 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "storage/index/b_plus_tree_index.h"
+#include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
+#include "storage/index/linear_probe_hash_table_index.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
@@ -113,19 +115,50 @@ class Catalog {
    * @param key_schema the schema of the key
    * @param key_attrs key attributes
    * @param keysize size of the key
+   * @param is_unique whether the key identifies a row; the key of a non-unique B+ tree index also holds the RID of the
+   * row
+   * @param index_type the data structure of the index, the hash indexes are for lookups of whole keys only
    * @return a pointer to the metadata of the new table
    */
   template <class KeyType, class ValueType, class KeyComparator>
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
-                         size_t keysize) {
-    auto index_metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs);
-    auto index = std::make_unique<BPLUSTREE_INDEX_TYPE>(index_metadata, bpm_);
+                         size_t keysize, bool is_unique = true, IndexType index_type = IndexType::BPlusTree) {
+    auto index_metadata = new IndexMetadata(index_name, table_name, &schema, key_attrs, is_unique, index_type);
 
     auto table_metadata = GetTable(table_name);
-    for (auto iter = table_metadata->table_->Begin(txn); iter != table_metadata->table_->End(); iter++) {
-      Tuple index_key = iter->KeyFromTuple(schema, key_schema, key_attrs);
-      index->InsertEntry(index_key, iter->GetRid(), txn);
+    // scan the table through a ring of frames, the pages of the new index are the ones that should stay cached
+    BufferAccessStrategy strategy;
+    auto iter = table_metadata->table_->Begin(txn, &strategy);
+    auto next_entry = [&](Tuple *key, RID *rid) {
+      if (iter == table_metadata->table_->End()) {
+        return false;
+      }
+      *key = iter->KeyFromTuple(schema, key_schema, key_attrs);
+      *rid = iter->GetRid();
+      iter++;
+      return true;
+    };
+
+    std::unique_ptr<Index> index;
+    if (index_type == IndexType::BPlusTree) {
+      auto tree_index = std::make_unique<BPLUSTREE_INDEX_TYPE>(index_metadata, bpm_);
+      // sort the entries and build the tree bottom-up, instead of descending it once per tuple
+      tree_index->BulkLoad(next_entry);
+      index = std::move(tree_index);
+    } else {
+      if (index_type == IndexType::Hash) {
+        index = std::make_unique<HASH_TABLE_INDEX_TYPE>(index_metadata, bpm_, HASH_INDEX_NUM_BUCKETS,
+                                                        HashFunction<KeyType>());
+      } else {
+        index = std::make_unique<EXTENDIBLE_HASH_TABLE_INDEX_TYPE>(index_metadata, bpm_, HashFunction<KeyType>());
+      }
+      // a hash index has no order to be built in, the entries are inserted one after the other
+      Tuple key;
+      RID rid;
+      while (next_entry(&key, &rid)) {
+        index->InsertEntry(key, rid, txn);
+      }
     }
 
     auto oid = next_index_oid_.fetch_add(1);
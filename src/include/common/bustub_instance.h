@@ -33,6 +33,7 @@ class BustubInstance {
     log_manager_ = new LogManager(disk_manager_);
 
     buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    buffer_pool_manager_->StartPageCleaner();
 
     // txn related
     lock_manager_ = new LockManager();
@@ -27,6 +27,9 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background page cleaner of a buffer pool writes dirty pages every PAGE_CLEANER_INTERVAL milliseconds. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,6 +38,15 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // accesses remembered by LRU-K
+static constexpr int LRUK_CORRELATED_REFERENCE_PERIOD = 0;                    // LRU-K correlated period (in accesses)
+static constexpr int SCAN_RING_SIZE = 32;                                     // frames recycled by a scan
+static constexpr int PAGE_CLEANER_MAX_PAGES = 16;                             // pages cleaned per round
+static constexpr int DISK_SCHEDULER_QUEUE_DEPTH = 64;                         // disk requests in flight
+static constexpr int EXTENT_SIZE = 64;                                        // pages per extent of a segment
+static constexpr int EXTERNAL_SORT_MEMORY_PAGES = 1024;                       // memory of an external sort
+static constexpr int INDEX_JOIN_BATCH_SIZE = 256;                             // outer tuples probed at once
+static constexpr int HASH_INDEX_NUM_BUCKETS = 1024;                           // initial buckets of a hash index
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -13,7 +13,9 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
@@ -24,26 +26,97 @@ namespace bustub {
 
 using hash_t = std::size_t;
 
+/**
+ * Hashing utilities. Byte strings are hashed in the style of wyhash: 16 bytes (48 bytes for long inputs) are folded
+ * per step with a 64x64->128 bit multiply, and inputs of up to 16 bytes take a single multiply-fold.
+ */
 class HashUtil {
  private:
   static const hash_t prime_factor = 10000019;
 
+  static constexpr uint64_t SECRET0 = 0xa0761d6478bd642fULL;
+  static constexpr uint64_t SECRET1 = 0xe7037ed1a0b428dbULL;
+  static constexpr uint64_t SECRET2 = 0x8ebc6af09c88c6e3ULL;
+  static constexpr uint64_t SECRET3 = 0x589965cc75374cc3ULL;
+
+  /** Multiplies a and b into 128 bits, leaving the low half in a and the high half in b. */
+  static inline void MultiplyWide(uint64_t *a, uint64_t *b) {
+    __uint128_t product = static_cast<__uint128_t>(*a) * *b;
+    *a = static_cast<uint64_t>(product);
+    *b = static_cast<uint64_t>(product >> 64);
+  }
+
+  /** @return the xor of the two halves of a * b */
+  static inline uint64_t Mix(uint64_t a, uint64_t b) {
+    MultiplyWide(&a, &b);
+    return a ^ b;
+  }
+
+  static inline uint64_t Read8(const uint8_t *p) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline uint64_t Read4(const uint8_t *p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  /** Reads 1 to 3 bytes. */
+  static inline uint64_t Read3(const uint8_t *p, size_t length) {
+    return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+  }
+
  public:
-  static inline hash_t HashBytes(const char *bytes, size_t length) {
-    // https://github.com/greenplum-db/gpos/blob/b53c1acd6285de94044ff91fbee91589543feba1/libgpos/src/utils.cpp#L126
-    hash_t hash = length;
-    for (size_t i = 0; i < length; ++i) {
-      hash = ((hash << 5) ^ (hash >> 27)) ^ bytes[i];
+  static inline hash_t HashBytes(const char *bytes, size_t length, uint64_t seed = 0) {
+    const auto *p = reinterpret_cast<const uint8_t *>(bytes);
+    seed ^= Mix(seed ^ SECRET0, SECRET1);
+    uint64_t a;
+    uint64_t b;
+    if (length <= 16) {
+      if (length >= 4) {
+        // two possibly overlapping 4 byte reads from each end cover all the bytes
+        size_t offset = (length >> 3) << 2;
+        a = (Read4(p) << 32) | Read4(p + offset);
+        b = (Read4(p + length - 4) << 32) | Read4(p + length - 4 - offset);
+      } else if (length > 0) {
+        a = Read3(p, length);
+        b = 0;
+      } else {
+        a = b = 0;
+      }
+    } else {
+      size_t remaining = length;
+      if (remaining > 48) {
+        uint64_t seed1 = seed;
+        uint64_t seed2 = seed;
+        do {
+          seed = Mix(Read8(p) ^ SECRET1, Read8(p + 8) ^ seed);
+          seed1 = Mix(Read8(p + 16) ^ SECRET2, Read8(p + 24) ^ seed1);
+          seed2 = Mix(Read8(p + 32) ^ SECRET3, Read8(p + 40) ^ seed2);
+          p += 48;
+          remaining -= 48;
+        } while (remaining > 48);
+        seed ^= seed1 ^ seed2;
+      }
+      while (remaining > 16) {
+        seed = Mix(Read8(p) ^ SECRET1, Read8(p + 8) ^ seed);
+        p += 16;
+        remaining -= 16;
+      }
+      // the last 16 bytes, overlapping what was already consumed
+      a = Read8(p + remaining - 16);
+      b = Read8(p + remaining - 8);
     }
-    return hash;
+    a ^= SECRET1;
+    b ^= seed;
+    MultiplyWide(&a, &b);
+    return Mix(a ^ SECRET0 ^ length, b ^ SECRET1);
   }
 
-  static inline hash_t CombineHashes(hash_t l, hash_t r) {
-    hash_t both[2];
-    both[0] = l;
-    both[1] = r;
-    return HashBytes(reinterpret_cast<char *>(both), sizeof(hash_t) * 2);
-  }
+  static inline hash_t CombineHashes(hash_t l, hash_t r) { return Mix(l ^ SECRET0, r ^ SECRET1); }
 
   static inline hash_t SumHashes(hash_t l, hash_t r) { return (l % prime_factor + r % prime_factor) % prime_factor; }
 
@@ -98,6 +171,74 @@ class HashUtil {
       }
     }
   }
+
+  /**
+   * Hashes a column of values at a time. The values must all have the same type; the type is dispatched on once for
+   * the whole column.
+   * @param values the column
+   * @param count the number of values
+   * @param[out] hashes the hash of every value, the same as HashValue, or 0 for null values
+   */
+  static inline void HashValues(const Value *values, size_t count, hash_t *hashes) {
+    std::fill(hashes, hashes + count, 0);
+    ForEachHash(values, count, [hashes](size_t i, hash_t hash) { hashes[i] = hash; });
+  }
+
+  /**
+   * Combines the hashes of a column of values into hashes, skipping null values. Calling this once for every column
+   * of a row-wise key gives the same hashes as combining the values of each key in order.
+   * @param values the column
+   * @param count the number of values
+   * @param[in,out] hashes the hashes to combine into
+   */
+  static inline void CombineHashValues(const Value *values, size_t count, hash_t *hashes) {
+    ForEachHash(values, count, [hashes](size_t i, hash_t hash) { hashes[i] = CombineHashes(hashes[i], hash); });
+  }
+
+ private:
+  template <typename T, typename Raw, typename Visitor>
+  static inline void ForEachWordHash(const Value *values, size_t count, Visitor &&visit) {
+    for (size_t i = 0; i < count; i++) {
+      if (!values[i].IsNull()) {
+        auto raw = static_cast<Raw>(values[i].GetAs<T>());
+        visit(i, Hash<Raw>(&raw));
+      }
+    }
+  }
+
+  /** Visits the hash of every non-null value. */
+  template <typename Visitor>
+  static inline void ForEachHash(const Value *values, size_t count, Visitor &&visit) {
+    if (count == 0) {
+      return;
+    }
+    switch (values[0].GetTypeId()) {
+      case TypeId::TINYINT:
+        return ForEachWordHash<int8_t, int64_t>(values, count, visit);
+      case TypeId::SMALLINT:
+        return ForEachWordHash<int16_t, int64_t>(values, count, visit);
+      case TypeId::INTEGER:
+        return ForEachWordHash<int32_t, int64_t>(values, count, visit);
+      case TypeId::BIGINT:
+        return ForEachWordHash<int64_t, int64_t>(values, count, visit);
+      case TypeId::BOOLEAN:
+        return ForEachWordHash<bool, bool>(values, count, visit);
+      case TypeId::DECIMAL:
+        return ForEachWordHash<double, double>(values, count, visit);
+      case TypeId::TIMESTAMP:
+        return ForEachWordHash<uint64_t, uint64_t>(values, count, visit);
+      case TypeId::VARCHAR:
+        for (size_t i = 0; i < count; i++) {
+          if (!values[i].IsNull()) {
+            visit(i, HashBytes(values[i].GetData(), values[i].GetLength()));
+          }
+        }
+        return;
+      default: {
+        BUSTUB_ASSERT(false, "Unsupported type.");
+      }
+    }
+  }
 };
 
 }  // namespace bustub
@@ -0,0 +1,210 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table.h
+//
+// Identification: src/include/container/hash/extendible_hash_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction.h"
+#include "container/hash/hash_function.h"
+#include "container/hash/hash_table.h"
+#include "storage/disk/segment.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+#define EXTENDIBLE_HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
+
+/**
+ * Implementation of extendible hash table that is backed by a buffer pool
+ * manager. Non-unique keys are supported. Supports insert and delete. The
+ * table grows one bucket at a time.
+ *
+ * The directory maps the lowest global depth bits of a hash to a bucket page. A full bucket is split in two by one more
+ * bit of the hash, which doubles the directory only if the bucket was the only one of its directory index; a bucket
+ * that becomes empty is merged back into its split image. The directory starts out in a single page, and spreads over
+ * more directory pages once it outgrows it. Inserts, removes and lookups hold table_latch_ in read mode and latch the
+ * bucket; a split or merge holds it in write mode, only for as long as it takes to move the pairs of one bucket.
+ *
+ * All pairs of a key are kept in the same bucket. A full bucket whose pairs the directory can't tell apart, because
+ * their hashes agree in their lowest MAX_GLOBAL_DEPTH bits, like the pairs of a key with many values, is not split but
+ * gets an overflow page instead.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
+ public:
+  /**
+   * Creates a new ExtendibleHashTable, with a single bucket
+   *
+   * @param buffer_pool_manager buffer pool manager to be used
+   * @param comparator comparator for keys
+   * @param hash_fn the hash function
+   */
+  explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+
+  /**
+   * Inserts a key-value pair into the hash table.
+   * @param transaction the current transaction
+   * @param key the key to create
+   * @param value the value to be associated with the key
+   * @return true if insert succeeded, false otherwise
+   */
+  bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Deletes the associated value for the given key.
+   * @param transaction the current transaction
+   * @param key the key to delete
+   * @param value the value to delete
+   * @return true if remove succeeded, false otherwise
+   */
+  bool Remove(Transaction *transaction, const KeyType &key, const ValueType &value) override;
+
+  /**
+   * Performs a point query on the hash table.
+   * @param transaction the current transaction
+   * @param key the key to look up
+   * @param[out] result the value(s) associated with a given key
+   * @return the value(s) associated with the given key
+   */
+  bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
+
+  /**
+   * Gets the global depth of the directory
+   * @return the number of bits of a hash that index the directory
+   */
+  uint32_t GetGlobalDepth();
+
+ private:
+  /**
+   * @return the bits of the hash of a key that index the directory
+   */
+  uint32_t Hash(const KeyType &key);
+
+  /**
+   * Splits the bucket of a key until it has room for the pair, or gives it an overflow page, then inserts the pair.
+   * Takes table_latch_ in write mode.
+   */
+  bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
+
+  /**
+   * Merges the empty buckets on the way to the bucket of a key with their split images, and halves the directory while
+   * it can. Takes table_latch_ in write mode.
+   */
+  void Merge(Transaction *transaction, const KeyType &key);
+
+  /**
+   * Fetches a page of the table, throwing if the buffer pool is out of frames.
+   */
+  Page *FetchPage(page_id_t page_id);
+
+  /**
+   * @return the page id of the bucket at a directory index; table_latch_ must be held
+   */
+  page_id_t GetBucketPageId(uint32_t directory_idx);
+
+  /**
+   * @return the local depth of the bucket at a directory index; table_latch_ must be held
+   */
+  uint32_t GetLocalDepth(uint32_t directory_idx);
+
+  /**
+   * Calls visit(directory_page, slot, directory_idx) for the directory indexes first, first + stride, ... of the
+   * directory, fetching each directory page once. visit returns whether it changed the directory page. table_latch_
+   * must be held, in write mode to change the directory.
+   */
+  template <typename Visitor>
+  void VisitDirectory(uint32_t first, uint32_t stride, Visitor &&visit);
+
+  /**
+   * Doubles the directory: the new upper half refers to the same buckets as the lower half. table_latch_ must be
+   * held in write mode.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Halves the directory, dropping its upper half. table_latch_ must be held in write mode.
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return whether all buckets have a local depth below the global depth, so that the directory can be halved
+   */
+  bool CanShrink();
+
+  /**
+   * Writes global_depth_ and directory_page_ids_ into the first directory page.
+   */
+  void StoreDirectoryRoot();
+
+  /**
+   * Collects the values of a key from the pages of a bucket. The caller latches the first page of the bucket, which
+   * covers its overflow pages, or holds table_latch_ in write mode; so do the callers of the other Chain functions.
+   */
+  bool ChainGetValue(page_id_t bucket_page_id, const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Inserts a pair into the first page of a bucket with room, unless the bucket has the pair.
+   * @param[out] full set if no page of the bucket has room for the pair
+   * @return whether the pair was inserted
+   */
+  bool ChainInsert(page_id_t bucket_page_id, const KeyType &key, const ValueType &value, bool *full);
+
+  /**
+   * Removes the pairs for which remove(key, value) returns true from the pages of a bucket, and unlinks the overflow
+   * pages that become empty.
+   * @return the number of removed pairs
+   */
+  template <typename Predicate>
+  uint32_t ChainRemove(page_id_t bucket_page_id, Predicate &&remove);
+
+  /**
+   * @return whether splitting the bucket would tell apart its pairs and the key by more bits of their hashes
+   */
+  bool CanSplit(page_id_t bucket_page_id, const KeyType &key);
+
+  /**
+   * Appends an empty overflow page to a bucket.
+   */
+  void AppendOverflowPage(page_id_t bucket_page_id);
+
+  /**
+   * Splits the bucket at a directory index in two by one more bit of the hash. The directory must have room for it.
+   */
+  void SplitBucket(uint32_t bucket_idx, page_id_t bucket_page_id);
+
+  // member variable
+  page_id_t directory_page_id_;
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+
+  // Readers includes inserts and removes, writer is only split and merge
+  ReaderWriterLatch table_latch_;
+
+  // Hash function
+  HashFunction<KeyType> hash_fn_;
+
+  // The pages of the table are allocated from their own extents
+  Segment segment_;
+  // Copy of the global depth and the directory page ids of the first directory page, so that a lookup only fetches
+  // the directory page of its index; changed by a split or merge only
+  uint32_t global_depth_{0};
+  std::vector<page_id_t> directory_page_ids_;
+};
+
+}  // namespace bustub
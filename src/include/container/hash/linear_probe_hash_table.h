@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -20,6 +21,7 @@
 #include "concurrency/transaction.h"
 #include "container/hash/hash_function.h"
 #include "container/hash/hash_table.h"
+#include "storage/disk/segment.h"
 #include "storage/page/hash_table_block_page.h"
 #include "storage/page/hash_table_header_page.h"
 #include "storage/page/hash_table_page_defs.h"
@@ -32,6 +34,14 @@ namespace bustub {
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * The buckets of the table are spread over block pages, bucket i is slot i % BLOCK_ARRAY_SIZE of the
+ * (i / BLOCK_ARRAY_SIZE)-th block listed in the header pages, which form a chain once one header page is too small.
+ * Inserts, removes and lookups hold table_latch_ in read mode and latch the blocks of the probe sequence one after the
+ * other, so they only wait for each other on the same block. Removed pairs leave tombstones behind. Once three quarters
+ * of the buckets are occupied, an insert resizes the table: holding table_latch_ in write mode, the pairs are moved to
+ * new blocks with twice as many buckets as pairs, which drops the tombstones. A resize that runs out of frames leaves
+ * the table as it was.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -87,6 +97,44 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   size_t GetSize();
 
  private:
+  /**
+   * Walks the probe sequence of a key, from its bucket until an unoccupied bucket or all buckets have been visited.
+   * Each block of the sequence is latched while its buckets are visited; table_latch_ must be held.
+   * @param key the key whose buckets are visited
+   * @param exclusive whether the blocks are latched in write mode
+   * @param visit called with the block and the slot of each pair of the sequence whose fingerprint matches the one of
+   * the key, returns true to end the walk
+   * @param visit_end called with the block, the slot and the fingerprint of the key for the unoccupied bucket that
+   * ends the sequence
+   * @return true if visit ended the walk or the sequence reached an unoccupied bucket, false if all buckets are
+   * occupied
+   */
+  template <typename Visitor, typename EndVisitor>
+  bool Probe(const KeyType &key, bool exclusive, Visitor &&visit, EndVisitor &&visit_end);
+
+  /**
+   * Allocates zeroed block pages for a number of buckets.
+   * @param num_buckets the least number of buckets, rounded up to whole blocks
+   * @param[out] block_page_ids the page ids of the new blocks, which are appended to an empty vector
+   * @return false if the buffer pool is out of frames, in which case no block is left allocated
+   */
+  bool AllocateBlocks(size_t num_buckets, std::vector<page_id_t> *block_page_ids);
+
+  /**
+   * Deletes block pages, and clears their page ids.
+   */
+  void DeleteBlocks(std::vector<page_id_t> *block_page_ids);
+
+  /**
+   * Records block_page_ids_ and num_buckets_ in the header pages, appending header pages to the chain as needed.
+   */
+  void StoreBlockPageIds();
+
+  /**
+   * Fetches a page of the table, throwing if the buffer pool is out of frames.
+   */
+  Page *FetchPage(page_id_t page_id);
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
@@ -97,6 +145,16 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
 
   // Hash function
   HashFunction<KeyType> hash_fn_;
+
+  // The pages of the table are allocated from their own extents
+  Segment segment_;
+  // Copy of the block page ids and the number of buckets of the header pages, so that a probe doesn't fetch them;
+  // changed by a resize only
+  std::vector<page_id_t> block_page_ids_;
+  size_t num_buckets_;
+  // The number of pairs, and the number of occupied buckets, which also counts tombstones
+  std::atomic<size_t> num_pairs_{0};
+  std::atomic<size_t> num_occupied_{0};
 };
 
 }  // namespace bustub
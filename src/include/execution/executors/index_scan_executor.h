@@ -13,6 +13,7 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "common/rid.h"
@@ -25,6 +26,10 @@ namespace bustub {
 
 /**
  * IndexScanExecutor executes an index scan over a table.
+ *
+ * Comparisons of the key column with constants that are and-ed together in the predicate bound the range of keys
+ * that is scanned: the scan seeks to the first key in the range and stops after the last one. The predicate is still
+ * evaluated on every tuple, bounds are only derived for single column keys.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -46,11 +51,21 @@ class IndexScanExecutor : public AbstractExecutor {
   using IndexType = BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
   using IndexIteratorType = IndexIterator<GenericKey<8>, RID, GenericComparator<8>>;
 
+  /** Tighten the key bounds with the comparisons of the key column in the and-ed terms of expr. */
+  void DeriveBounds(const AbstractExpression *expr);
+
+  /** @return true if the key is past the bound where the scan ends */
+  bool IsPastEnd(const GenericKey<8> &key) const;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   IndexType *index_;
   std::unique_ptr<IndexIteratorType> iter_;
   TableMetadata *table_metadata_;
   Transaction *txn_;
+  GenericComparator<8> comparator_;
+  /** The smallest and the largest key that can satisfy the predicate, both inclusive, if there is such a bound. */
+  std::optional<GenericKey<8>> lower_key_;
+  std::optional<GenericKey<8>> upper_key_;
 };
 }  // namespace bustub
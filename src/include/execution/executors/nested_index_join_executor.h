@@ -29,7 +29,8 @@
 namespace bustub {
 
 /**
- * IndexJoinExecutor executes index join operations.
+ * IndexJoinExecutor executes index join operations. The outer tuples are read in batches of INDEX_JOIN_BATCH_SIZE,
+ * whose keys are looked up in the index all at once.
  */
 class NestIndexJoinExecutor : public AbstractExecutor {
  public:
@@ -55,5 +56,16 @@ class NestIndexJoinExecutor : public AbstractExecutor {
   TableMetadata *inner_table_metadata_;
   IndexInfo *inner_index_info_;
   const ColumnValueExpression *left_col_value_expr_, *right_col_value_expr_;
+  /** Read the next batch of outer tuples and look up their keys. @return false if there are no more outer tuples */
+  bool NextBatch();
+
+  /** The current batch of outer tuples. */
+  std::vector<Tuple> outer_tuples_;
+  /** The RIDs of the inner tuples matching each outer tuple, several if the index is not unique. */
+  std::vector<std::vector<RID>> inner_rids_;
+  /** The current outer tuple of the batch. */
+  size_t next_outer_tuple_{0};
+  /** The next of the inner RIDs of the current outer tuple to join. */
+  size_t next_inner_rid_{0};
 };
 }  // namespace bustub
@@ -44,6 +44,8 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
   std::unique_ptr<TableIterator> iter_;
+  /** The scan reads the table through a ring of frames, so that it does not flush the rest of the buffer pool. */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
   TableMetadata *table_metadata_;
   Transaction *txn_;
 };
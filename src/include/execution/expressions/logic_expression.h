@@ -0,0 +1,75 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// logic_expression.h
+//
+// Identification: src/include/expression/logic_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** LogicType represents the type of logical connective that we want to apply. */
+enum class LogicType { And, Or };
+
+/**
+ * LogicExpression represents two boolean expressions being combined, e.g. the two comparisons of a BETWEEN.
+ */
+class LogicExpression : public AbstractExpression {
+ public:
+  /** Creates a new logic expression representing (left logic_type right). */
+  LogicExpression(const AbstractExpression *left, const AbstractExpression *right, LogicType logic_type)
+      : AbstractExpression({left, right}, TypeId::BOOLEAN), logic_type_{logic_type} {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
+    Value rhs = GetChildAt(1)->Evaluate(tuple, schema);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    Value lhs = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    Value rhs = GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
+    Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
+    return ValueFactory::GetBooleanValue(PerformLogic(lhs, rhs));
+  }
+
+  /** @return the type of the logical connective */
+  LogicType GetLogicType() const { return logic_type_; }
+
+ private:
+  /** A null operand, e.g. the result of comparing with a null value, counts as false. */
+  static bool IsTrue(const Value &value) { return !value.IsNull() && value.GetAs<int8_t>() != 0; }
+
+  bool PerformLogic(const Value &lhs, const Value &rhs) const {
+    switch (logic_type_) {
+      case LogicType::And:
+        return IsTrue(lhs) && IsTrue(rhs);
+      case LogicType::Or:
+        return IsTrue(lhs) || IsTrue(rhs);
+      default:
+        BUSTUB_ASSERT(false, "Unsupported logic type.");
+    }
+  }
+
+  LogicType logic_type_;
+};
+}  // namespace bustub
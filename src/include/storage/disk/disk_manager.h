@@ -13,30 +13,69 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <string>
+#include <unordered_set>
+#include <vector>
 
 #include "common/config.h"
 
 namespace bustub {
 
+class Segment;
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with positional I/O on a raw file descriptor, so page I/O from different threads runs
+ * concurrently. A page write only reaches the operating system; it is durable once SyncDatabase has returned.
+ *
+ * Deallocated pages are tracked in a free-page bitmap and handed out again by AllocatePage before the file grows. The
+ * bitmap is stored in dedicated free map pages inside the database file: the file is divided into groups of one free
+ * map page followed by FREE_MAP_PAGE_CAPACITY data pages, and the free map page has a small header and then one bit
+ * (1 = free) for each data page of its group. Free map pages have no page id, page ids only number the data pages.
+ * Freed pages are written back by SyncDatabase, but a reused page is marked allocated on disk before its id is handed
+ * out, so that a crash cannot hand it out twice. The free map is read again together with the number of allocated
+ * pages when the file is reopened; the header of the first free map page marks the file format, and files without it
+ * are rejected.
+ *
+ * Physical layout:
+ *  ------------------------------------------------------------------------------------
+ * | free map 0 | page 0 | ... | page CAPACITY - 1 | free map 1 | page CAPACITY | ... |
+ *  ------------------------------------------------------------------------------------
  */
 class DiskManager {
+  // the page writes that the scheduler issues on the file descriptor itself are counted like WritePage counts them
+  friend class DiskScheduler;
+
  public:
+  /** The size of the header of a free map page: the magic number of the file format and the index of the group. */
+  static constexpr size_t FREE_MAP_HEADER_SIZE = 8;
+
+  /** The number of data pages whose state one free map page holds. */
+  static constexpr page_id_t FREE_MAP_PAGE_CAPACITY = (PAGE_SIZE - FREE_MAP_HEADER_SIZE) * 8;
+
+  /** The magic number at the start of every free map page. */
+  static constexpr uint32_t FREE_MAP_MAGIC = 0x4246534d;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @throws Exception if the file exists but is not a database file of this format
    */
   explicit DiskManager(const std::string &db_file);
 
-  ~DiskManager() = default;
+  /**
+   * Closes the database file if ShutDown has not been called.
+   */
+  virtual ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager, syncing the database file and the free map, and close all the file resources.
    */
   void ShutDown();
 
@@ -45,14 +84,34 @@ class DiskManager {
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Write the free map back and make it and all the page writes that have returned so far durable.
+   */
+  void SyncDatabase();
+
+  /**
+   * @param page_id id of the page
+   * @return the offset of the page in the database file
+   */
+  static int64_t GetPageOffset(page_id_t page_id) {
+    return (static_cast<int64_t>(page_id) + page_id / FREE_MAP_PAGE_CAPACITY + 1) * PAGE_SIZE;
+  }
+
+  /**
+   * The file descriptor asynchronous page I/O is issued on. Subclasses that intercept ReadPage/WritePage return -1,
+   * so that all page I/O goes through them.
+   * @return the file descriptor of the database file, -1 if there is none
+   */
+  virtual int GetDatabaseFd() { return db_fd_; }
 
   /**
    * Flush the entire log buffer into disk.
@@ -71,17 +130,43 @@ class DiskManager {
   bool ReadLog(char *log_data, int size, int offset);
 
   /**
-   * Allocate a page on disk.
+   * Allocate a page on disk. The free page with the lowest id is reused if there is one, otherwise the file grows.
    * @return the id of the allocated page
    */
   page_id_t AllocatePage();
 
   /**
-   * Deallocate a page on disk.
+   * Allocate a run of contiguous pages on disk. The lowest run of free pages that is long enough is reused if there is
+   * one, otherwise the file grows.
+   * @param num_pages the number of pages to allocate
+   * @return the id of the first allocated page, the others follow it
+   */
+  page_id_t AllocateExtent(size_t num_pages);
+
+  /**
+   * Deallocate a page on disk, so that AllocatePage can hand it out again. Deallocating a page that is not allocated
+   * has no effect.
    * @param page_id id of the page to deallocate
    */
   void DeallocatePage(page_id_t page_id);
 
+  /**
+   * Registers a segment that reserved an extent. The pages of its current extent that it has not handed out are freed
+   * when the segment is released, or at the latest when the disk manager shuts down.
+   * @param segment the segment
+   */
+  void RegisterSegment(Segment *segment);
+
+  /**
+   * Frees the pages of the current extent of a registered segment that it has not handed out, and forgets the
+   * segment. Releasing a segment that is not registered has no effect.
+   * @param segment the segment
+   */
+  void ReleaseSegment(Segment *segment);
+
+  /** @return the number of deallocated pages that have not been reused yet */
+  size_t GetNumFreePages();
+
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
 
@@ -91,6 +176,9 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of times the database file has been synced */
+  int GetNumSyncs() const;
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -102,15 +190,52 @@ class DiskManager {
 
  private:
   int GetFileSize(const std::string &file_name);
+
+  /**
+   * Read the free map pages of the database file and the number of allocated pages. An empty file gets its first free
+   * map page.
+   * @return false if the file does not start with a free map page
+   */
+  bool LoadFreeMap();
+
+  /** Write the free map pages that changed since they were last written. Must be called with free_map_latch_ held. */
+  void WriteFreeMap();
+
+  /** Write the free map pages that changed and sync the db file. Must be called with free_map_latch_ held. */
+  void PersistFreeMap();
+
+  /** Sync the data of the db file to disk. */
+  void SyncFile();
+
+  /** Release all the registered segments, which are detached from this disk manager. */
+  void ReleaseSegments();
+
+  /** Deallocate the pages of the current extent of a segment that it has not handed out. */
+  void FreeUnusedPages(Segment *segment);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file, -1 once it is closed
+  std::atomic<int> db_fd_;
   std::string file_name_;
-  std::atomic<page_id_t> next_page_id_;
+  /** Protects next_page_id_, free_map_ and the free page bookkeeping. */
+  std::mutex free_map_latch_;
+  page_id_t next_page_id_;
+  /** The free map pages, one PAGE_SIZE slice per group. */
+  std::vector<char> free_map_;
+  /** Whether a free map page changed since it was last written. */
+  std::vector<bool> free_map_dirty_;
+  size_t num_free_pages_{0};
+  /** No page below this id is free. */
+  page_id_t free_map_hint_{0};
+  /** Protects segments_. */
+  std::mutex segments_latch_;
+  /** The segments with an extent that may have pages they have not handed out. */
+  std::unordered_set<Segment *> segments_;
   int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_writes_;
+  std::atomic<int> num_syncs_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
 };
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Represents a read or write of one page that the DiskScheduler performs.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+  /** Pointer to the start of the page in memory to write from or read into. Must stay valid until completion. */
+  char *data_;
+  /** ID of the page being read from / written to disk. */
+  page_id_t page_id_;
+  /** Fulfilled with true once the request has completed successfully, with false if it failed. */
+  std::promise<bool> callback_;
+  /** Optional function called on an I/O thread once the request has completed, before callback_ is fulfilled. */
+  std::function<void(bool)> on_complete_;
+};
+
+/**
+ * DiskScheduler performs page reads and writes asynchronously. Requests are queued and the caller gets a future, or
+ * a completion callback, instead of waiting for the I/O. Many requests can be in flight at the same time.
+ *
+ * On Linux the requests are issued through an io_uring with up to queue_depth operations in flight, submitted and
+ * reaped by a single I/O thread. If io_uring is not available, or if the disk manager does not expose its file
+ * descriptor, a pool of threads performs the requests with DiskManager::ReadPage/WritePage instead. Other platforms
+ * always use the thread pool.
+ *
+ * Requests are not ordered with respect to each other: a caller that needs one request to finish before another one
+ * starts (e.g. writing a page back before reading another page into the same buffer) must wait in between.
+ */
+class DiskScheduler {
+ public:
+  /** The mechanism the requests are performed with. */
+  enum class Backend { IO_URING, THREAD_POOL };
+
+  /**
+   * Creates a new DiskScheduler and starts its I/O threads.
+   * @param disk_manager the disk manager the requests go to
+   * @param queue_depth the maximum number of requests in flight
+   * @param backend the preferred backend; IO_URING falls back to THREAD_POOL if it cannot be used
+   */
+  explicit DiskScheduler(DiskManager *disk_manager, size_t queue_depth = DISK_SCHEDULER_QUEUE_DEPTH,
+                         Backend backend = Backend::IO_URING);
+
+  /**
+   * Finishes the requests that are still queued, then stops the I/O threads.
+   */
+  ~DiskScheduler();
+
+  DISALLOW_COPY(DiskScheduler);
+
+  /**
+   * Schedule a request.
+   * @param request the request to perform
+   */
+  void Schedule(DiskRequest request);
+
+  /**
+   * Schedule several requests at once, so that they can be submitted together.
+   * @param requests the requests to perform
+   */
+  void Schedule(std::vector<DiskRequest> requests);
+
+  /**
+   * Schedule the read of a page.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, must stay valid until the read has completed
+   * @return a future that becomes ready with the success of the read
+   */
+  std::future<bool> ScheduleRead(page_id_t page_id, char *page_data);
+
+  /**
+   * Schedule the write of a page.
+   * @param page_id id of the page
+   * @param page_data raw page data, must stay valid and unchanged until the write has completed
+   * @return a future that becomes ready with the success of the write
+   */
+  std::future<bool> ScheduleWrite(page_id_t page_id, const char *page_data);
+
+  /** @return the backend the requests are actually performed with */
+  Backend GetBackend() const { return backend_; }
+
+ private:
+  /** State of the io_uring, only touched by the I/O thread. */
+  struct IoUring;
+
+  /** Completes a request: runs its completion function and fulfills its promise. */
+  static void Complete(DiskRequest *request, bool success);
+
+  /** Performs a request synchronously with DiskManager::ReadPage/WritePage and completes it. */
+  void Perform(DiskRequest *request);
+
+  /** Set up the io_uring. @return false if io_uring is not available */
+  bool SetUpIoUring();
+
+  /** Body of the I/O thread of the io_uring backend. */
+  void RunIoUring();
+
+  /**
+   * Complete the requests whose completions the kernel has posted.
+   * @param[in,out] num_in_flight the number of requests in the ring
+   */
+  void ReapIoUring(size_t *num_in_flight);
+
+  /**
+   * Stop using a ring that failed: perform the requests the kernel has not taken yet synchronously, and wait for the
+   * kernel to complete the others.
+   * @param sq_tail the tail of the submission queue
+   * @param[in,out] num_in_flight the number of requests in the ring, 0 afterwards
+   */
+  void AbandonIoUring(unsigned sq_tail, size_t *num_in_flight);
+
+  /** Body of an I/O thread of the thread pool backend. */
+  void RunThreadPoolWorker();
+
+  DiskManager *disk_manager_;
+  size_t queue_depth_;
+  /** Only changes if the io_uring fails, the I/O thread then goes on like a thread pool worker. */
+  std::atomic<Backend> backend_;
+  std::unique_ptr<IoUring> ring_;
+
+  /** Protects queue_ and stopping_. */
+  std::mutex latch_;
+  /** Signalled when requests are queued or the scheduler is stopped. */
+  std::condition_variable cv_;
+  /** Requests that have not been handed to the kernel or a worker yet. */
+  std::deque<DiskRequest> queue_;
+  bool stopping_{false};
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace bustub
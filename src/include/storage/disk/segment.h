@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// segment.h
+//
+// Identification: src/include/storage/disk/segment.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * A Segment holds the pages of one database object, e.g. a table heap or a B+ tree. It reserves contiguous extents of
+ * pages from the disk manager and hands its pages out one after the other, so that pages the object allocates in a
+ * row are also next to each other on disk, no matter how many other objects allocate pages at the same time.
+ *
+ * The extents of a segment are not recorded on disk. The pages of the current extent that have not been handed out yet
+ * are freed again when the segment is destroyed, or when the disk manager shuts down while the segment is still around.
+ */
+class Segment {
+  friend class DiskManager;
+
+ public:
+  /**
+   * Creates a new, empty Segment.
+   * @param extent_size the number of pages reserved at once
+   */
+  explicit Segment(size_t extent_size = EXTENT_SIZE) : extent_size_(extent_size) {}
+
+  DISALLOW_COPY_AND_MOVE(Segment);
+
+  ~Segment() {
+    if (disk_manager_ != nullptr) {
+      disk_manager_->ReleaseSegment(this);
+    }
+  }
+
+  /**
+   * Allocate a page of the segment, reserving a new extent if the current one is used up.
+   * @param disk_manager the disk manager the extents are reserved from
+   * @return the id of the allocated page
+   */
+  page_id_t AllocatePage(DiskManager *disk_manager) {
+    std::unique_lock guard(latch_);
+    bool first_extent = disk_manager_ == nullptr;
+    if (next_page_id_ == end_page_id_) {
+      disk_manager_ = disk_manager;
+      next_page_id_ = disk_manager->AllocateExtent(extent_size_);
+      end_page_id_ = next_page_id_ + static_cast<page_id_t>(extent_size_);
+    }
+    page_id_t page_id = next_page_id_++;
+    guard.unlock();
+    // the disk manager latches the segments it knows before this one, so register without holding the latch
+    if (first_extent) {
+      disk_manager->RegisterSegment(this);
+    }
+    return page_id;
+  }
+
+  /** @return the number of pages reserved at once */
+  size_t GetExtentSize() const { return extent_size_; }
+
+ private:
+  /** @return the pages of the current extent that have not been handed out, which the segment gives up */
+  std::pair<page_id_t, page_id_t> TakeUnusedPages() {
+    std::scoped_lock guard(latch_);
+    auto unused = std::make_pair(next_page_id_, end_page_id_);
+    next_page_id_ = end_page_id_;
+    return unused;
+  }
+
+  /** Forgets the disk manager, once it has released the segment. */
+  void Detach() {
+    std::scoped_lock guard(latch_);
+    disk_manager_ = nullptr;
+  }
+
+  std::mutex latch_;
+  /** The disk manager the extents are reserved from, nullptr before the first extent or once it released them. */
+  DiskManager *disk_manager_{nullptr};
+  size_t extent_size_;
+  /** The next page handed out, and the end of the current extent. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
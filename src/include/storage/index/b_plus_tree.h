@@ -12,11 +12,14 @@
 
 #include <atomic>
 #include <map>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
 
 #include "concurrency/transaction.h"
+#include "storage/disk/segment.h"
+#include "storage/index/external_sorter.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -30,10 +33,29 @@ namespace bustub {
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique; a non-unique index makes its keys unique by appending the RID of the row (see GenericKey)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * In B-link mode (Lehman & Yao), every node has a right link to its sibling on the same level and a high key, the
+ * first key of that sibling. A split first moves the upper half of the node to a new right sibling and links it, which
+ * is a consistent state on its own: a descent that reaches the node with a key at or past its high key moves right.
+ * The separator is then inserted into the parent in a second step, without holding the child. So writers descend with
+ * read latches like readers do and hold at most two latches at a time, the node and its right sibling, instead of
+ * write latching the path down from the highest node that may split. Removing a key doesn't merge nodes in B-link mode,
+ * so nodes may get empty, and the pages of a B-link tree are never freed while it exists.
+ *
+ * With slotted keys, the pages store every key in as many bytes as it needs (see SlottedKeys), which lets a page hold
+ * many more short keys, like strings, than fit in fixed size slots as long as the longest key. A node is full when a
+ * pair with the longest key may not fit anymore, and the separator of a leaf split is the shortest key between the
+ * two leaves. The max sizes only limit the number of pairs of a node then, SLOTTED_LEAF_PAGE_SIZE and
+ * SLOTTED_INTERNAL_PAGE_SIZE don't limit it at all.
+ *
+ * Inserts with increasing keys, like serial ids or timestamps, all go to the right-most leaf. Once APPEND_THRESHOLD
+ * inserts in a row have appended to it, the tree splits the right-most node of a level unevenly, so that the node keeps
+ * almost all of its pairs: with a 50/50 split, such a tree would be half empty. Appends also go straight to the
+ * right-most leaf then, without a descent from the root, as long as the leaf has room.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -42,7 +64,8 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool b_link = false, bool slotted = false);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
@@ -56,11 +79,36 @@ class BPlusTree {
   // return the value associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * Look up many keys at once. The keys are probed in key order, and a leaf and its parent stay latched while the
+   * next keys fall into them, so that keys close to each other share the descent and the leaf instead of each one
+   * starting from the root.
+   * @param keys the keys, in any order and possibly repeated
+   * @param[out] result result[i] gets the value of keys[i], empty if the key is not in the tree
+   */
+  void GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result,
+                 Transaction *transaction = nullptr);
+
+  /**
+   * Bulk load an empty tree: the pairs are sorted first, then the leaves are filled in key order and the internal
+   * levels are built bottom-up on top of them, instead of inserting the pairs one by one. Every level is split into
+   * as few nodes as the fill factor allows, with the pairs spread evenly over them. Must not run concurrently with
+   * other operations on the tree.
+   * @param sorter the pairs to load, not sorted yet; of pairs with the same key, only the first added one is loaded
+   * @param fill_factor how full the nodes are made, from 0 to 1 (as full as they stay without splitting)
+   * @return false if the tree is not empty, nothing is loaded then
+   */
+  bool BulkLoad(ExternalSorter<KeyType, ValueType, KeyComparator> *sorter, double fill_factor = 1.0);
+
   // index iterator
   INDEXITERATOR_TYPE begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE end();
 
+  // descending index iterator, from the last key / the last key not greater than the given key, ends at end()
+  INDEXITERATOR_TYPE RBegin();
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
   }
@@ -73,7 +121,7 @@ class BPlusTree {
     out.close();
   }
 
-  // read data from file and insert one by one
+  // read data from file and insert one by one, or bulk load it if the tree is empty
   void InsertFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
   // read data from file and remove one by one
@@ -82,10 +130,28 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool left_most = false);
 
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
   bool StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
+  // insert and remove in B-link mode
+  bool BLinkInsert(const KeyType &key, const ValueType &value);
+
+  /**
+   * Insert the separator of a split node into its parent in B-link mode, splitting the parent in turn if it fills up.
+   * @param node_page_id the split node
+   * @param key the separator, the first key of the new node
+   * @param new_page_id the new right sibling of the split node
+   * @param level the level of the split node, 0 for a leaf
+   * @param path the internal pages on the way down to the node, from the root; they may have split since
+   */
+  void BLinkInsertIntoParent(page_id_t node_page_id, KeyType key, page_id_t new_page_id, size_t level,
+                             std::vector<page_id_t> *path);
+
+  void BLinkRemove(const KeyType &key);
+
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
 
@@ -104,6 +170,30 @@ class BPlusTree {
 
   bool AdjustRoot(BPlusTreePage *node);
 
+  /** The node of one level of the tree that a bulk load is currently filling. */
+  struct BulkLoadLevel {
+    /** Number of pairs (for the leaves) or children (for the internal pages) on the level. */
+    int num_items;
+    /** Number of nodes on the level. */
+    int num_nodes;
+    /** Number of nodes started so far. */
+    int node_index;
+    /** Number of items that still go into the current node. */
+    int items_left;
+    /** The current node, pinned; nullptr before the first node is started. */
+    Page *page;
+  };
+
+  /**
+   * Get the node of a bulk loaded level the next item goes into. If the current node is full, it is unpinned and the
+   * next node of the level is started, and added to the parent level.
+   * @param levels the levels of the tree, from the leaves up
+   * @param height the level, 0 for the leaves
+   * @param key the key of the next item, which becomes the separator key of a new node in its parent
+   * @return the node, pinned
+   */
+  Page *BulkLoadNode(std::vector<BulkLoadLevel> *levels, size_t height, const KeyType &key);
+
   void UpdateRootPageId(bool insert_record = false);
 
   enum class LatchMode { INSERT, DELETE, READ, UPDATE };
@@ -125,6 +215,92 @@ class BPlusTree {
 
   Page *InternalFindLeafPage(const KeyType *key, bool left_most, LatchMode latch_mode);
 
+  /**
+   * Optimistic lock coupling: descend to the leaf without latching any page. The pages are found with
+   * FetchPageOptimistic, which neither takes the buffer pool latch nor pins them for real. The version of every page is
+   * read before the page is used and validated after the next page has been reached, so that a concurrent writer, or
+   * the page leaving its frame, is detected.
+   * @param key the key to find the leaf of, ignored if left_most is set
+   * @param left_most whether to find the left most leaf instead
+   * @param pin_leaf whether to pin the leaf like FetchPage does, so that it can be latched
+   * @param[out] leaf the leaf page, not latched and pinned either way, nullptr if the tree is empty. An optimistic pin
+   *             is dropped with UnpinPageOptimistic.
+   * @param[out] leaf_version the version of the leaf, reads from it are only valid if it still validates afterwards
+   * @return false if a concurrent writer got in the way, the descent has to be restarted then
+   */
+  bool OptimisticFindLeafPage(const KeyType *key, bool left_most, bool pin_leaf, Page **leaf, uint64_t *leaf_version);
+
+  /**
+   * Find a page for an optimistic read, reading it into the buffer pool first if it is not there.
+   * @param page_id id of the page
+   * @param[out] version the version of the page
+   * @return the page with an optimistic pin, nullptr if it could not be found without the latch
+   */
+  Page *OptimisticFetchPage(page_id_t page_id, uint64_t *version);
+
+  /**
+   * Find the last key that is less than key (not greater than key if inclusive) for a descending scan. The leaves are
+   * only linked to the right, so the descent is repeated whenever a scan goes past the first key of a leaf.
+   * @param key the key, nullptr to find the last key of the tree
+   * @param inclusive whether the key itself qualifies
+   * @param[out] index the index of the found key in its leaf
+   * @return the leaf with the found key, pinned and read latched; nullptr if there is no such key
+   */
+  Page *FindLeafPageBefore(const KeyType *key, bool inclusive, int *index);
+
+  /**
+   * Descend with read latch coupling to the lowest internal page on the path to key, for GetValues.
+   * @param key the key
+   * @param[out] upper the smallest key that is not below the returned page anymore, if bounded
+   * @param[out] bounded false if every key greater than key is below the returned page
+   * @return the internal page, or the root if it is a leaf, pinned and read latched; nullptr if the tree is empty
+   */
+  Page *FindLeafParentPage(const KeyType &key, KeyType *upper, bool *bounded);
+
+  /**
+   * Descend in B-link mode with read latch coupling, moving right on every level where the key is past the high key.
+   * @param key the key to find the leaf of, ignored if left_most is set
+   * @param left_most whether to find the left most leaf instead
+   * @param exclusive whether to write latch the leaf
+   * @param[out] path if not nullptr, gets the internal pages on the way down, from the root
+   * @return the leaf page, pinned and latched; nullptr if the tree is empty
+   */
+  Page *BLinkFindLeafPage(const KeyType *key, bool left_most, bool exclusive, std::vector<page_id_t> *path);
+
+  /**
+   * In B-link mode, follow the right links from the latched page as long as the key is past the high key. The latch on
+   * the next page is taken before the one on the current page is released. Does nothing if not in B-link mode.
+   * @param page the page, pinned and latched
+   * @param key the key, nullptr to move to the last page of the level
+   * @param exclusive whether the pages are write latched
+   * @param before whether the page for the keys right before key is wanted, i.e. whether to stay at a page whose high
+   * key is key
+   * @param[out] low_key if not nullptr and the page changed, gets the high key of the page left behind last, i.e. the
+   * smallest key of the returned page
+   * @return the page that covers key, pinned and latched
+   */
+  Page *MoveRight(Page *page, const KeyType *key, bool exclusive, bool before = false, KeyType *low_key = nullptr);
+
+  /** How often an optimistic descent is restarted before falling back to latch coupling. */
+  static constexpr int OPTIMISTIC_ATTEMPTS = 4;
+
+  /**
+   * Count an insert for the detection of appends: whether the key went to the end of the right-most leaf.
+   * @param leaf_page the leaf the key was inserted into, latched
+   * @param key the key
+   */
+  void CountAppend(const LeafPage *leaf_page, const KeyType &key);
+
+  /**
+   * Append a pair to the right-most leaf without a descent from the root, if the tree gets appends, the key is greater
+   * than all keys of the leaf and the leaf doesn't have to split.
+   * @return whether the pair was appended
+   */
+  bool AppendToRightmostLeaf(const KeyType &key, const ValueType &value);
+
+  /** How many inserts in a row have to append to the right-most leaf before the tree is optimized for appends. */
+  static constexpr int APPEND_THRESHOLD = 16;
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -137,6 +313,18 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  /** The pages of the tree are allocated from its own extents. */
+  Segment segment_;
+  /** Whether the tree is a B-link tree. */
+  bool b_link_;
+  /** In B-link mode, serializes replacing the root with a new one. */
+  std::mutex root_latch_;
+  /** Whether the pages of the tree are in the slotted format. */
+  bool slotted_;
+  /** The number of the last inserts that appended to the right-most leaf, up to APPEND_THRESHOLD. */
+  std::atomic<int> appends_{0};
+  /** The right-most leaf, for appends; checked once latched, since it may have split or been merged meanwhile. */
+  std::atomic<page_id_t> rightmost_leaf_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <string>
 #include <vector>
@@ -22,6 +23,11 @@ namespace bustub {
 
 #define BPLUSTREE_INDEX_TYPE BPlusTreeIndex<KeyType, ValueType, KeyComparator>
 
+/**
+ * BPlusTreeIndex maps keys to RIDs through a BPlusTree. The tree only holds unique keys, so the keys of a non-unique
+ * index end with the RID of their row (see GenericKey), and a key lookup scans the range of tree keys that start with
+ * the key columns.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeIndex : public Index {
  public:
@@ -31,15 +37,36 @@ class BPlusTreeIndex : public Index {
 
   void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
 
+  // find the RIDs of all the rows with the key, at most one for a unique index
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  // find the RIDs of many keys with one batched lookup, see BPlusTree::GetValues
+  void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                Transaction *transaction) override;
+
+  /**
+   * Bulk load the empty index, see BPlusTree::BulkLoad.
+   * @param next_entry produces the entries to load one after the other, returns false when there are no more
+   * @param fill_factor how full the nodes of the tree are made
+   * @return false if the index is not empty, nothing is loaded then
+   */
+  bool BulkLoad(const std::function<bool(Tuple *key, RID *rid)> &next_entry, double fill_factor = 1.0);
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
 
   INDEXITERATOR_TYPE GetEndIterator();
 
+  // descending iterators, from the last key / the last key not greater than the given key
+  INDEXITERATOR_TYPE GetReverseBeginIterator();
+
+  INDEXITERATOR_TYPE GetReverseBeginIterator(const KeyType &key);
+
  protected:
+  // build the tree key of the row with the key tuple, which includes the RID if the index is not unique
+  void SetIndexKey(KeyType *index_key, const Tuple &key, RID rid);
+
   // comparator for key
   KeyComparator comparator_;
   // container
@@ -0,0 +1,203 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sorter.h
+//
+// Identification: src/include/storage/index/external_sorter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+#define EXTERNAL_SORTER_TYPE ExternalSorter<KeyType, ValueType, KeyComparator>
+
+/**
+ * ExternalSorter sorts key & value pairs by key, e.g. to bulk load a B+ tree from them, and drops the pairs whose key
+ * is a duplicate of an earlier added one.
+ *
+ * Pairs are collected in memory. Whenever more of them than fit into the memory budget have been added, they are
+ * sorted and spilled to a temporary file as one sorted run. Sort then merges the runs, so that Next returns the pairs
+ * in key order. If all the pairs fit into memory, nothing is written to disk.
+ *
+ * KeyType and ValueType are copied byte by byte to and from the run files, so they must be trivially copyable.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+class ExternalSorter {
+ public:
+  /**
+   * Creates a new, empty ExternalSorter.
+   * @param comparator the key comparator
+   * @param memory_pages the memory budget, in pages
+   */
+  explicit ExternalSorter(const KeyComparator &comparator, size_t memory_pages = EXTERNAL_SORT_MEMORY_PAGES)
+      : comparator_(comparator),
+        max_pairs_in_memory_(std::max<size_t>(1, memory_pages * PAGE_SIZE / sizeof(MappingType))) {}
+
+  ~ExternalSorter() {
+    for (auto *run : runs_) {
+      fclose(run);
+    }
+    if (output_ != nullptr) {
+      fclose(output_);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(ExternalSorter);
+
+  /**
+   * Add a pair. Must not be called after Sort.
+   * @param key the key
+   * @param value the value
+   */
+  void Add(const KeyType &key, const ValueType &value) {
+    pairs_.emplace_back(key, value);
+    if (pairs_.size() >= max_pairs_in_memory_) {
+      runs_.push_back(SpillRun());
+    }
+  }
+
+  /**
+   * Sort the pairs added so far and drop the duplicate keys. Afterwards, Next returns the pairs in key order.
+   */
+  void Sort() {
+    if (runs_.empty()) {
+      SortInMemory();
+      size_ = pairs_.size();
+      return;
+    }
+    if (!pairs_.empty()) {
+      runs_.push_back(SpillRun());
+    }
+    // merge the runs into one file, counting the distinct keys on the way
+    output_ = CreateTempFile();
+    using Head = std::pair<MappingType, size_t>;
+    // the pair of the earlier run goes first among equal keys, so that the first added pair of a key wins
+    auto greater = [&](const Head &a, const Head &b) {
+      int cmp = comparator_(a.first.first, b.first.first);
+      return cmp > 0 || (cmp == 0 && a.second > b.second);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(greater)> heads(greater);
+    MappingType pair;
+    for (size_t i = 0; i < runs_.size(); i++) {
+      rewind(runs_[i]);
+      if (fread(&pair, sizeof(pair), 1, runs_[i]) == 1) {
+        heads.emplace(pair, i);
+      }
+    }
+    while (!heads.empty()) {
+      auto [head, run] = heads.top();
+      heads.pop();
+      if (size_ == 0 || comparator_(head.first, last_key_) != 0) {
+        Write(output_, head);
+        last_key_ = head.first;
+        size_++;
+      }
+      if (fread(&pair, sizeof(pair), 1, runs_[run]) == 1) {
+        heads.emplace(pair, run);
+      }
+    }
+    for (auto *run : runs_) {
+      fclose(run);
+    }
+    runs_.clear();
+    rewind(output_);
+  }
+
+  /** @return the number of distinct keys, only valid after Sort */
+  size_t GetSize() const { return size_; }
+
+  /** @return the number of sorted runs that have been spilled to disk so far */
+  size_t GetNumSpilledRuns() const { return num_spilled_runs_; }
+
+  /**
+   * Get the next pair in key order. Must only be called after Sort.
+   * @param[out] key the key
+   * @param[out] value the value
+   * @return false if all the pairs have been returned
+   */
+  bool Next(KeyType *key, ValueType *value) {
+    MappingType pair;
+    if (output_ != nullptr) {
+      if (fread(&pair, sizeof(pair), 1, output_) != 1) {
+        return false;
+      }
+    } else {
+      if (next_ >= pairs_.size()) {
+        return false;
+      }
+      pair = pairs_[next_++];
+    }
+    *key = pair.first;
+    *value = pair.second;
+    return true;
+  }
+
+ private:
+  /** Sort the pairs in memory, keeping only the first added pair of every key. */
+  void SortInMemory() {
+    std::stable_sort(pairs_.begin(), pairs_.end(),
+                     [&](const MappingType &a, const MappingType &b) { return comparator_(a.first, b.first) < 0; });
+    auto last = std::unique(pairs_.begin(), pairs_.end(), [&](const MappingType &a, const MappingType &b) {
+      return comparator_(a.first, b.first) == 0;
+    });
+    pairs_.erase(last, pairs_.end());
+  }
+
+  /** Sort the pairs in memory and write them to a new run file. @return the run file */
+  FILE *SpillRun() {
+    SortInMemory();
+    FILE *run = CreateTempFile();
+    for (const auto &pair : pairs_) {
+      Write(run, pair);
+    }
+    pairs_.clear();
+    num_spilled_runs_++;
+    return run;
+  }
+
+  static FILE *CreateTempFile() {
+    FILE *file = tmpfile();
+    if (file == nullptr) {
+      throw Exception("ExternalSorter can't create a temporary file");
+    }
+    return file;
+  }
+
+  static void Write(FILE *file, const MappingType &pair) {
+    if (fwrite(&pair, sizeof(pair), 1, file) != 1) {
+      throw Exception("ExternalSorter can't write to a temporary file");
+    }
+  }
+
+  KeyComparator comparator_;
+  size_t max_pairs_in_memory_;
+  /** Pairs not spilled yet, or all the pairs if nothing was spilled. */
+  std::vector<MappingType> pairs_;
+  /** Sorted runs on disk. */
+  std::vector<FILE *> runs_;
+  size_t num_spilled_runs_{0};
+  /** The merged runs, nullptr if nothing was spilled. */
+  FILE *output_{nullptr};
+  /** Position of the next pair in pairs_ returned by Next. */
+  size_t next_{0};
+  size_t size_{0};
+  KeyType last_key_;
+};
+
+}  // namespace bustub
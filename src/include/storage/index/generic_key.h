@@ -13,7 +13,12 @@
 #pragma once
 
 #include <cstring>
+#include <string>
+#include <type_traits>
 
+#include "common/exception.h"
+#include "common/macros.h"
+#include "common/rid.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -25,73 +30,232 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * The columns of the key are stored normalized, one after the other, so that two keys compare like their columns do
+ * when their bytes are compared with memcmp:
+ * - integers are stored big-endian, with the sign bit flipped so that negative numbers come first
+ * - timestamps are stored big-endian
+ * - decimals are stored big-endian, with the sign bit set for positive numbers and all bits flipped for negative ones
+ * - varchars are stored byte by byte, with 0x00 escaped as 0x00 0xFF, and terminated with 0x00 0x00
+ * Whatever does not fit into KeySize is cut off, so keys that only differ past KeySize bytes compare equal.
+ * The keys of a non-unique index end with the RID of their row, encoded like two integers. Their key columns must fit
+ * into the bytes before the RID (see MaxEncodedSize), as rows whose key columns compare equal are taken to have the
+ * same key.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
     // intialize to 0
     memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+    size_t offset = 0;
+    for (uint32_t i = 0; i < key_schema->GetColumnCount(); i++) {
+      offset = EncodeValue(tuple.GetValue(key_schema, i), offset);
+    }
+  }
+
+  /**
+   * Set the key of a non-unique index: the key tuple, followed by the RID of the row as the last RID_SUFFIX_SIZE bytes.
+   * The keys of rows with equal key columns then still differ, and are ordered by RID. The key columns keep the first
+   * KeySize - RID_SUFFIX_SIZE bytes, which the index makes sure they fit into.
+   */
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema, const RID &rid) {
+    if constexpr (KeySize > RID_SUFFIX_SIZE) {
+      SetFromKey(tuple, key_schema);
+      EncodeInteger(rid.GetPageId(), KeySize - RID_SUFFIX_SIZE);
+      EncodeInteger(rid.GetSlotNum(), KeySize - RID_SUFFIX_SIZE + sizeof(page_id_t));
+    } else {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "GenericKey is too small for a RID suffix");
+    }
+  }
+
+  /** @return whether both keys of a non-unique index have the same key columns, i.e. only differ in the RID suffix */
+  inline bool HasSameColumns(const GenericKey &other) const {
+    return KeySize <= RID_SUFFIX_SIZE || memcmp(data_, other.data_, KeySize - RID_SUFFIX_SIZE) == 0;
+  }
+
+  /**
+   * @return the most bytes the key columns with the schema may take when encoded: a varchar takes two bytes for every
+   * character when all of them are 0x00, plus the terminator
+   */
+  static size_t MaxEncodedSize(const Schema *key_schema) {
+    size_t size = 0;
+    for (const auto &column : key_schema->GetColumns()) {
+      size += column.GetType() == TypeId::VARCHAR ? 2 * column.GetVariableLength() + 2 : column.GetFixedLength();
+    }
+    return size;
   }
 
   // NOTE: for test purpose only
+  // the key is encoded like a single BIGINT column, or like an INTEGER column if it is smaller than a BIGINT
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    if constexpr (KeySize < sizeof(int64_t)) {
+      EncodeInteger(static_cast<int32_t>(key), 0);
+    } else {
+      EncodeInteger(key, 0);
+    }
   }
 
-  inline Value ToValue(Schema *schema, uint32_t column_idx) const {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
+  inline Value ToValue(const Schema *schema, uint32_t column_idx) const {
+    // the columns before may be varchars, so the offset of the column is only known after decoding them
+    size_t offset = 0;
+    for (uint32_t i = 0; i < column_idx; i++) {
+      DecodeValue(schema->GetColumn(i).GetType(), &offset);
     }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return DecodeValue(schema->GetColumn(column_idx).GetType(), &offset);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // interpret the key as it is encoded by SetFromInteger
+  inline int64_t ToString() const {
+    size_t offset = 0;
+    if constexpr (KeySize < sizeof(int64_t)) {
+      return DecodeInteger<int32_t>(&offset);
+    } else {
+      return DecodeInteger<int64_t>(&offset);
+    }
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // interpret the key as it is encoded by SetFromInteger
   friend std::ostream &operator<<(std::ostream &os, const GenericKey &key) {
     os << key.ToString();
     return os;
   }
 
+  /** Number of bytes taken by the RID at the end of the keys of a non-unique index. */
+  static constexpr size_t RID_SUFFIX_SIZE = sizeof(page_id_t) + sizeof(uint32_t);
+
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  inline void PutByte(size_t offset, uint8_t byte) {
+    if (offset < KeySize) {
+      data_[offset] = static_cast<char>(byte);
+    }
+  }
+
+  inline uint8_t GetByte(size_t offset) const { return offset < KeySize ? static_cast<uint8_t>(data_[offset]) : 0; }
+
+  template <typename T>
+  inline size_t EncodeInteger(T value, size_t offset) {
+    using U = std::make_unsigned_t<T>;
+    auto bits = static_cast<U>(value);
+    if constexpr (std::is_signed_v<T>) {
+      bits ^= static_cast<U>(U{1} << (sizeof(T) * 8 - 1));
+    }
+    for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+      PutByte(offset++, static_cast<uint8_t>(bits >> shift));
+    }
+    return offset;
+  }
+
+  template <typename T>
+  inline T DecodeInteger(size_t *offset) const {
+    using U = std::make_unsigned_t<T>;
+    U bits = 0;
+    for (size_t i = 0; i < sizeof(T); i++) {
+      bits = static_cast<U>((bits << 8) | GetByte((*offset)++));
+    }
+    if constexpr (std::is_signed_v<T>) {
+      bits ^= static_cast<U>(U{1} << (sizeof(T) * 8 - 1));
+    }
+    return static_cast<T>(bits);
+  }
+
+  inline size_t EncodeValue(const Value &value, size_t offset) {
+    switch (value.GetTypeId()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return EncodeInteger(value.GetAs<int8_t>(), offset);
+      case TypeId::SMALLINT:
+        return EncodeInteger(value.GetAs<int16_t>(), offset);
+      case TypeId::INTEGER:
+        return EncodeInteger(value.GetAs<int32_t>(), offset);
+      case TypeId::BIGINT:
+        return EncodeInteger(value.GetAs<int64_t>(), offset);
+      case TypeId::TIMESTAMP:
+        return EncodeInteger(value.GetAs<uint64_t>(), offset);
+      case TypeId::DECIMAL: {
+        auto d = value.GetAs<double>();
+        uint64_t bits;
+        memcpy(&bits, &d, sizeof(bits));
+        bits = (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+        return EncodeInteger(bits, offset);
+      }
+      case TypeId::VARCHAR: {
+        // a null varchar is stored like an empty one, only the terminator
+        if (!value.IsNull()) {
+          const char *data = value.GetData();
+          for (uint32_t i = 0; i < value.GetLength(); i++) {
+            PutByte(offset++, static_cast<uint8_t>(data[i]));
+            if (data[i] == 0) {
+              PutByte(offset++, 0xFF);
+            }
+          }
+        }
+        PutByte(offset++, 0);
+        PutByte(offset++, 0);
+        return offset;
+      }
+      default:
+        UNREACHABLE("GenericKey can't encode a value of this type");
+    }
+  }
+
+  inline Value DecodeValue(TypeId type, size_t *offset) const {
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        return Value(type, DecodeInteger<int8_t>(offset));
+      case TypeId::SMALLINT:
+        return Value(type, DecodeInteger<int16_t>(offset));
+      case TypeId::INTEGER:
+        return Value(type, DecodeInteger<int32_t>(offset));
+      case TypeId::BIGINT:
+        return Value(type, DecodeInteger<int64_t>(offset));
+      case TypeId::TIMESTAMP:
+        return Value(type, DecodeInteger<uint64_t>(offset));
+      case TypeId::DECIMAL: {
+        auto bits = DecodeInteger<uint64_t>(offset);
+        bits = (bits >> 63) != 0 ? bits & ~(uint64_t{1} << 63) : ~bits;
+        double d;
+        memcpy(&d, &bits, sizeof(d));
+        return Value(type, d);
+      }
+      case TypeId::VARCHAR: {
+        std::string str;
+        while (*offset < KeySize) {
+          uint8_t byte = GetByte((*offset)++);
+          if (byte == 0 && GetByte((*offset)++) == 0) {
+            break;
+          }
+          str.push_back(static_cast<char>(byte));
+        }
+        if (str.empty()) {
+          return Value(type);
+        }
+        return Value(type, str.data(), static_cast<uint32_t>(str.size()), true);
+      }
+      default:
+        UNREACHABLE("GenericKey can't decode a value of this type");
+    }
+  }
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * The keys are normalized, see GenericKey, so they are simply compared byte by byte. The key schema is only needed to
+ * build the keys.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
-    }
-    // equals
-    return 0;
+    return memcmp(lhs.data_, rhs.data_, KeySize);
   }
 
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
@@ -100,7 +264,7 @@ class GenericComparator {
   explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
 
  private:
-  Schema *key_schema_;
+  [[maybe_unused]] Schema *key_schema_;
 };
 
 }  // namespace bustub
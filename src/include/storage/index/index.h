@@ -23,6 +23,13 @@
 
 namespace bustub {
 
+/**
+ * The data structure of an index: a B+ tree supports ordered scans, a hash table only finds the rows of a key, with
+ * fewer page accesses. A linear probing hash table rehashes all pairs when it grows, an extendible hash table splits
+ * one bucket at a time.
+ */
+enum class IndexType { BPlusTree, Hash, ExtendibleHash };
+
 /**
  * class IndexMetadata - Holds metadata of an index object
  *
@@ -37,8 +44,12 @@ class IndexMetadata {
   IndexMetadata() = delete;
 
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true, IndexType index_type = IndexType::BPlusTree)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique),
+        index_type_(index_type) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -60,13 +71,20 @@ class IndexMetadata {
   //  columns
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  // Returns whether every key maps to at most one RID, otherwise rows may share a key
+  inline bool IsUnique() const { return is_unique_; }
+
+  // Returns the data structure of the index
+  inline IndexType GetIndexType() const { return index_type_; }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
 
     os << "IndexMetadata["
        << "Name = " << name_ << ", "
-       << "Type = B+Tree, "
+       << "Type = " << IndexTypeName() << ", "
+       << "Unique = " << is_unique_ << ", "
        << "Table name = " << table_name_ << "] :: ";
     os << key_schema_->ToString();
 
@@ -74,10 +92,25 @@ class IndexMetadata {
   }
 
  private:
+  const char *IndexTypeName() const {
+    switch (index_type_) {
+      case IndexType::Hash:
+        return "Hash";
+      case IndexType::ExtendibleHash:
+        return "ExtendibleHash";
+      default:
+        return "B+Tree";
+    }
+  }
+
   std::string name_;
   std::string table_name_;
   // The mapping relation between key schema and tuple schema
   const std::vector<uint32_t> key_attrs_;
+  // whether the key columns are unique
+  bool is_unique_;
+  // the data structure of the index
+  IndexType index_type_;
   // schema of the indexed key
   Schema *key_schema_;
 };
@@ -117,6 +150,8 @@ class Index {
 
   const std::vector<uint32_t> &GetKeyAttrs() const { return metadata_->GetKeyAttrs(); }
 
+  bool IsUnique() const { return metadata_->IsUnique(); }
+
   // Get a string representation for debugging
   std::string ToString() const {
     std::stringstream os;
@@ -137,6 +172,16 @@ class Index {
 
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  // find the RIDs of many keys, result[i] gets those of keys[i]; indexes that can share work between the keys override
+  // this
+  virtual void ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                        Transaction *transaction) {
+    result->assign(keys.size(), std::vector<RID>());
+    for (size_t i = 0; i < keys.size(); i++) {
+      ScanKey(keys[i], &(*result)[i], transaction);
+    }
+  }
+
  private:
   //===--------------------------------------------------------------------===//
   //  Data members
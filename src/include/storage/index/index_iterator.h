@@ -19,12 +19,30 @@ namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
   using LeafPage = B_PLUS_TREE_LEAF_PAGE_TYPE;
+  using Tree = BPlusTree<KeyType, ValueType, KeyComparator>;
 
  public:
   IndexIterator(Page *page, int key_index, BufferPoolManager *buffer_pool_manager);
+  // a descending iterator, which finds every leaf before the current one through the tree
+  IndexIterator(Page *page, int key_index, BufferPoolManager *buffer_pool_manager, Tree *tree);
+  // the iterator owns the pin and the latch of its leaf, so it can only be moved, which leaves other at the end
+  IndexIterator(IndexIterator &&other) noexcept
+      : page_(other.page_),
+        key_index_(other.key_index_),
+        buffer_pool_manager_(other.buffer_pool_manager_),
+        is_end_(other.is_end_),
+        tree_(other.tree_) {
+    other.page_ = nullptr;
+    other.key_index_ = -1;
+    other.buffer_pool_manager_ = nullptr;
+    other.is_end_ = true;
+  }
   ~IndexIterator();
 
   bool isEnd();
@@ -40,10 +58,17 @@ class IndexIterator {
  private:
   void SetAsEnd();
 
+  /** Start reading the right sibling of the current leaf in the background. */
+  void PrefetchNextLeaf();
+
   Page *page_;
   int key_index_;
   BufferPoolManager *buffer_pool_manager_;
   bool is_end_;
+  /** The tree of a descending iterator, nullptr for an ascending one. */
+  Tree *tree_{nullptr};
+  /** The current pair of a slotted leaf. */
+  MappingType item_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,154 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * KeySearch finds the position of a key among the sorted key & value pairs of a B+ tree page. It is selected by the
+ * key and comparator types, so that key types with a cheaper representation can be searched with a faster kernel.
+ *
+ * The generic version is a binary search that calls the comparator.
+ */
+template <typename KeyType, typename KeyComparator>
+struct KeySearch {
+  /** @return the index of the first of the size pairs whose key is not less than key */
+  template <typename ValueType>
+  static int LowerBound(const std::pair<KeyType, ValueType> *array, int size, const KeyType &key,
+                        const KeyComparator &comparator) {
+    int l = 0;
+    int r = size;
+    while (l < r) {
+      int mid = (l + r) >> 1;
+      if (comparator(array[mid].first, key) < 0) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
+    }
+    return l;
+  }
+
+  /** @return the index of the first of the size pairs whose key is greater than key */
+  template <typename ValueType>
+  static int UpperBound(const std::pair<KeyType, ValueType> *array, int size, const KeyType &key,
+                        const KeyComparator &comparator) {
+    int l = 0;
+    int r = size;
+    while (l < r) {
+      int mid = (l + r) >> 1;
+      if (comparator(key, array[mid].first) >= 0) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
+    }
+    return l;
+  }
+};
+
+/**
+ * Search for 8 byte keys, i.e. single INTEGER or BIGINT columns. The normalized key is a big-endian unsigned integer,
+ * so it is loaded as a number and compared without calling the comparator. A binary search narrows the range down to
+ * a few cache lines, which are then scanned: with AVX2, four keys at a time.
+ *
+ * The keys stay interleaved with their values, since page iterators hand out references to whole pairs, so the scan
+ * gathers the keys with the stride of a pair. key_search_benchmark compares this with the scalar scan of
+ * key_search_scalar_benchmark.
+ */
+template <>
+struct KeySearch<GenericKey<8>, GenericComparator<8>> {
+  template <typename ValueType>
+  static int LowerBound(const std::pair<GenericKey<8>, ValueType> *array, int size, const GenericKey<8> &key,
+                        const GenericComparator<8> &comparator) {
+    return Search<false>(array, size, Load(key));
+  }
+
+  template <typename ValueType>
+  static int UpperBound(const std::pair<GenericKey<8>, ValueType> *array, int size, const GenericKey<8> &key,
+                        const GenericComparator<8> &comparator) {
+    return Search<true>(array, size, Load(key));
+  }
+
+ private:
+  /** Number of pairs that are scanned instead of being binary searched. */
+  static constexpr int SCAN_WINDOW = 16;
+
+  static uint64_t Load(const GenericKey<8> &key) {
+    uint64_t value;
+    memcpy(&value, key.data_, sizeof(value));
+    return __builtin_bswap64(value);
+  }
+
+  /** @return the index of the first pair whose key is not less than (upper: greater than) the target */
+  template <bool upper, typename ValueType>
+  static int Search(const std::pair<GenericKey<8>, ValueType> *array, int size, uint64_t target) {
+    int l = 0;
+    int r = size;
+    while (r - l > SCAN_WINDOW) {
+      int mid = (l + r) >> 1;
+      uint64_t mid_key = Load(array[mid].first);
+      if (upper ? mid_key <= target : mid_key < target) {
+        l = mid + 1;
+      } else {
+        r = mid;
+      }
+    }
+    // the keys are sorted, so the position is the number of keys in the window that come before the target
+    return l + CountBefore<upper>(array + l, r - l, target);
+  }
+
+  template <bool upper, typename ValueType>
+  static int CountBefore(const std::pair<GenericKey<8>, ValueType> *array, int size, uint64_t target) {
+    int count = 0;
+    int i = 0;
+#ifdef __AVX2__
+    constexpr auto stride = static_cast<int64_t>(sizeof(array[0]));
+    const __m256i offsets = _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0);
+    // reverses the bytes of every 64 bit lane
+    const __m256i bswap = _mm256_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+                                          15, 0, 1, 2, 3, 4, 5, 6, 7);
+    // AVX2 only compares signed numbers, flipping the sign bit of both sides makes that an unsigned comparison
+    const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i target_vec = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(target)), sign);
+    for (; i + 4 <= size; i += 4) {
+      __m256i keys = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(array[i].first.data_),  // NOLINT
+                                            offsets, 1);
+      keys = _mm256_xor_si256(_mm256_shuffle_epi8(keys, bswap), sign);
+      if constexpr (upper) {
+        // keys that are not greater than the target
+        count += 4 - __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(keys, target_vec))));
+      } else {
+        count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(target_vec, keys))));
+      }
+    }
+#endif
+    for (; i < size; i++) {
+      uint64_t key = Load(array[i].first);
+      count += static_cast<int>(upper ? key <= target : key < target);
+    }
+    return count;
+  }
+};
+
+}  // namespace bustub
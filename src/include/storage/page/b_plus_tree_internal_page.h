@@ -13,12 +13,16 @@
 #include <queue>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/b_plus_tree_slotted_keys.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
+#define INTERNAL_PAGE_HEADER_SIZE (32 + sizeof(KeyType))
 #define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+// the most children of an internal page in the slotted format, all with empty keys
+#define SLOTTED_INTERNAL_PAGE_SIZE \
+  ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(typename SlottedKeys<KeyType, page_id_t>::Slot))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -31,13 +35,27 @@ namespace bustub {
  *  --------------------------------------------------------------------------
  * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
  *  --------------------------------------------------------------------------
+ *
+ * The header is the common one, followed by the id of the right sibling on the same level (NextPageId, 4), MaxEntries
+ * (2), KeyBegin (2) and the high key (key size), like in a leaf page. The right sibling and the high key are only kept
+ * up to date by a B-link tree. MaxEntries and KeyBegin are only used by the slotted format, see BPlusTreeLeafPage.
  */
 
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
  public:
   // must call initialize method after "create" a new node
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE,
+            bool slotted = false);
+  bool IsSlotted() const;
+  // the number of children with keys of any length that fit into an empty slotted page
+  static int SlottedCapacity();
+
+  // the right sibling and the high key, used by a B-link tree; the high key is only valid if there is a right sibling
+  page_id_t GetNextPageId() const;
+  void SetNextPageId(page_id_t next_page_id);
+  const KeyType &GetHighKey() const;
+  void SetHighKey(const KeyType &high_key);
 
   KeyType KeyAt(int index) const;
   void SetKeyAt(int index, const KeyType &key);
@@ -45,14 +63,19 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   ValueType ValueAt(int index) const;
 
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator, bool before = false) const;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  int InsertNode(const KeyType &new_key, const ValueType &new_value, const KeyComparator &comparator);
+  // append a child that is greater than all the children of the page, used to bulk load the tree
+  void Append(const KeyType &key, const ValueType &value);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
   void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
+  void MoveTailTo(BPlusTreeInternalPage *recipient, int index, BufferPoolManager *buffer_pool_manager);
   void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                         BufferPoolManager *buffer_pool_manager);
   void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
@@ -63,6 +86,13 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
   void Adopt(page_id_t page_id, BufferPoolManager *buffer_pool_manager);
+  SlottedKeys<KeyType, ValueType> Slotted() const;
+  // the max size of a slotted page follows the room left for keys
+  void UpdateSlottedMaxSize();
+  page_id_t next_page_id_;
+  uint16_t max_entries_;
+  uint16_t key_begin_;
+  KeyType high_key_;
   MappingType array[0];
 };
 }  // namespace bustub
@@ -14,12 +14,16 @@
 #include <vector>
 
 #include "storage/page/b_plus_tree_page.h"
+#include "storage/page/b_plus_tree_slotted_keys.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE (32 + sizeof(KeyType))
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+// the most entries of a leaf page in the slotted format, all with empty keys
+#define SLOTTED_LEAF_PAGE_SIZE \
+  ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(typename SlottedKeys<KeyType, ValueType>::Slot))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
@@ -31,34 +35,56 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes + key size in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  ------------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | MaxEntries (2) | KeyBegin (2) | HighKey (key size)
+ *  ------------------------------------------------------------------------------------------------
+ *
+ * The high key is an upper bound of the keys in the page, the first key that belongs to the next page. It is only
+ * valid if there is a next page, and only kept up to date by a B-link tree (see BPlusTree), since merges don't update
+ * it.
+ *
+ * A page in the slotted format stores its pairs as SlottedKeys instead, every key taking only the bytes it needs.
+ * MaxEntries is the largest number of pairs it may have then, and KeyBegin where its keys start; both are 0 for the
+ * format above. The max size of a slotted page changes with its keys: it is the number of pairs it has plus the
+ * number of pairs with keys of any length that still fit. So a slotted page splits as soon as it may not have room for
+ * the next pair.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
  public:
   // After creating a new leaf page from buffer pool, must call initialize
   // method to set default values
-  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE);
+  void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = LEAF_PAGE_SIZE,
+            bool slotted = false);
+  bool IsSlotted() const;
+  // the number of pairs with keys of any length that fit into an empty slotted page
+  static int SlottedCapacity();
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  const KeyType &GetHighKey() const;
+  void SetHighKey(const KeyType &high_key);
   KeyType KeyAt(int index) const;
+  ValueType ValueAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+  int UpperKeyIndex(const KeyType &key, const KeyComparator &comparator) const;
+  // only for the fixed size format, a slotted page has no pairs to refer to
   const MappingType &GetItem(int index);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+  // append a pair that is greater than all the pairs in the page, used to bulk load the tree
+  void Append(const KeyType &key, const ValueType &value);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
+  void MoveTailTo(BPlusTreeLeafPage *recipient, int index);
   void MoveAllTo(BPlusTreeLeafPage *recipient);
   void MoveFirstToEndOf(BPlusTreeLeafPage *recipient);
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
@@ -67,7 +93,13 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void CopyNFrom(MappingType *items, int size);
   void CopyLastFrom(const MappingType &item);
   void CopyFirstFrom(const MappingType &item);
+  SlottedKeys<KeyType, ValueType> Slotted() const;
+  // the max size of a slotted page follows the room left for keys
+  void UpdateSlottedMaxSize();
   page_id_t next_page_id_;
+  uint16_t max_entries_;
+  uint16_t key_begin_;
+  KeyType high_key_;
   MappingType array[0];
 };
 }  // namespace bustub
@@ -0,0 +1,218 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_slotted_keys.h
+//
+// Identification: src/include/storage/page/b_plus_tree_slotted_keys.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * SlottedKeys is the entry area of a B+ tree page in the slotted format, which only stores as many bytes of every key
+ * as the key needs. The area starts with an array of slots, one per entry in key order, growing towards the end of
+ * the area. Every slot has the value of its entry and the offset and length of its key. The key bytes are packed at
+ * the end of the area, growing towards its start, with no holes between them.
+ *
+ *  ---------------------------------------------------------------------------------
+ * | SLOT(1) | SLOT(2) | ... | SLOT(n) | ... free ... | KEY(k) | ... | KEY(2) | KEY(1) |
+ *  ---------------------------------------------------------------------------------
+ *                                                    ^ key begin
+ *
+ * A key is stored without its trailing zero bytes. A GenericKey is padded with zeros, and a varchar column only uses a
+ * few bytes of it, so a short string takes only a few bytes instead of the whole key.
+ *
+ * It is a view on a page, constructed whenever the page needs it; the key begin is part of the page header.
+ */
+template <typename KeyType, typename ValueType>
+class SlottedKeys {
+ public:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t length_;
+    ValueType value_;
+  };
+
+  /** The most bytes an entry can take. */
+  static constexpr size_t MAX_ENTRY_SIZE = sizeof(Slot) + sizeof(KeyType);
+
+  /**
+   * @param area the entry area of the page
+   * @param area_size the size of the entry area
+   * @param key_begin the offset of the first key byte in the area, the area size if there are no keys
+   */
+  SlottedKeys(char *area, size_t area_size, uint16_t *key_begin)
+      : area_(area), area_size_(area_size), key_begin_(key_begin) {}
+
+  /** @return the number of bytes the key takes in the area, without its trailing zero bytes */
+  static uint16_t KeyLength(const KeyType &key) {
+    const char *bytes = reinterpret_cast<const char *>(&key);
+    size_t length = sizeof(KeyType);
+    while (length > 0 && bytes[length - 1] == 0) {
+      length--;
+    }
+    return static_cast<uint16_t>(length);
+  }
+
+  /**
+   * @return the shortest key that is greater than left and not greater than right, i.e. right cut off after the first
+   * byte it differs from left in, if the comparator agrees; right otherwise
+   */
+  template <typename KeyComparator>
+  static KeyType Separator(const KeyType &left, const KeyType &right, const KeyComparator &comparator) {
+    const char *left_bytes = reinterpret_cast<const char *>(&left);
+    const char *right_bytes = reinterpret_cast<const char *>(&right);
+    size_t length = 0;
+    while (length < sizeof(KeyType) && left_bytes[length] == right_bytes[length]) {
+      length++;
+    }
+    KeyType separator;
+    std::memset(reinterpret_cast<char *>(&separator), 0, sizeof(KeyType));
+    std::memcpy(reinterpret_cast<char *>(&separator), right_bytes, std::min(length + 1, sizeof(KeyType)));
+    if (comparator(left, separator) < 0 && comparator(separator, right) <= 0) {
+      return separator;
+    }
+    return right;
+  }
+
+  /** @return the number of free bytes between the slots and the keys of an area with size entries */
+  size_t FreeSpace(int size) const { return *key_begin_ - size * sizeof(Slot); }
+
+  /** @return the number of entries that always fit into an empty area, however long their keys are */
+  static int Capacity(size_t area_size) { return static_cast<int>(area_size / MAX_ENTRY_SIZE); }
+
+  /**
+   * @return the key of the entry at index. The offset and length of the key are kept within the area, so that a read
+   * of a page that is being changed (see BPlusTree::OptimisticFindLeafPage) only gets a wrong key.
+   */
+  KeyType KeyAt(int index) const {
+    const Slot &slot = Slots()[index];
+    size_t length = std::min<size_t>(slot.length_, sizeof(KeyType));
+    size_t offset = std::min<size_t>(slot.offset_, area_size_ - length);
+    KeyType key;
+    std::memset(reinterpret_cast<char *>(&key), 0, sizeof(KeyType));
+    std::memcpy(reinterpret_cast<char *>(&key), area_ + offset, length);
+    return key;
+  }
+
+  ValueType ValueAt(int index) const { return Slots()[index].value_; }
+
+  /** @return the number of bytes the entry at index takes */
+  size_t EntrySize(int index) const { return sizeof(Slot) + std::min<size_t>(Slots()[index].length_, sizeof(KeyType)); }
+
+  /** @return the index to split an area with size entries at, so that both parts take about the same number of bytes */
+  int SplitIndex(int size) const {
+    size_t total = 0;
+    for (int i = 0; i < size; i++) {
+      total += EntrySize(i);
+    }
+    size_t left = 0;
+    int index = 0;
+    while (index < size - 1 && (index == 0 || 2 * left < total)) {
+      left += EntrySize(index++);
+    }
+    return index;
+  }
+
+  /** @return the index of the first of the entries in [first, last) whose key is not less than key */
+  template <typename KeyComparator>
+  int LowerBound(int first, int last, const KeyType &key, const KeyComparator &comparator) const {
+    while (first < last) {
+      int mid = (first + last) >> 1;
+      if (comparator(KeyAt(mid), key) < 0) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    return first;
+  }
+
+  /** @return the index of the first of the entries in [first, last) whose key is greater than key */
+  template <typename KeyComparator>
+  int UpperBound(int first, int last, const KeyType &key, const KeyComparator &comparator) const {
+    while (first < last) {
+      int mid = (first + last) >> 1;
+      if (comparator(key, KeyAt(mid)) >= 0) {
+        first = mid + 1;
+      } else {
+        last = mid;
+      }
+    }
+    return first;
+  }
+
+  /** Insert an entry at index into an area with size entries, which must have room for it. */
+  void Insert(int size, int index, const KeyType &key, const ValueType &value) {
+    uint16_t length = KeyLength(key);
+    BUSTUB_ASSERT(FreeSpace(size) >= sizeof(Slot) + length, "no room for the entry");
+    *key_begin_ -= length;
+    std::memcpy(area_ + *key_begin_, reinterpret_cast<const char *>(&key), length);
+    Slot *slots = Slots();
+    std::copy_backward(slots + index, slots + size, slots + size + 1);
+    slots[index] = Slot{*key_begin_, length, value};
+  }
+
+  /** Remove the entry at index from an area with size entries. The keys stored before its key move up to its place. */
+  void Remove(int size, int index) {
+    Slot *slots = Slots();
+    Slot removed = slots[index];
+    // an empty key takes no bytes, so there is nothing to move; its offset may be anywhere
+    if (removed.length_ > 0) {
+      std::memmove(area_ + *key_begin_ + removed.length_, area_ + *key_begin_, removed.offset_ - *key_begin_);
+      *key_begin_ += removed.length_;
+      for (int i = 0; i < size; i++) {
+        if (slots[i].offset_ < removed.offset_) {
+          slots[i].offset_ += removed.length_;
+        }
+      }
+    }
+    std::copy(slots + index + 1, slots + size, slots + index);
+  }
+
+  /** Replace the key of the entry at index of an area with size entries, which must have room for the new key. */
+  void SetKeyAt(int size, int index, const KeyType &key) {
+    ValueType value = ValueAt(index);
+    Remove(size, index);
+    Insert(size - 1, index, key, value);
+  }
+
+  /** Remove all entries. */
+  void Clear() { *key_begin_ = static_cast<uint16_t>(area_size_); }
+
+  /** Remove all entries from index on, the keys of the others are packed anew. */
+  void Truncate(int index) {
+    std::vector<std::pair<KeyType, ValueType>> entries;
+    entries.reserve(index);
+    for (int i = 0; i < index; i++) {
+      entries.emplace_back(KeyAt(i), ValueAt(i));
+    }
+    Clear();
+    for (int i = 0; i < index; i++) {
+      Insert(i, i, entries[i].first, entries[i].second);
+    }
+  }
+
+ private:
+  Slot *Slots() const { return reinterpret_cast<Slot *>(area_); }
+
+  char *area_;
+  size_t area_size_;
+  uint16_t *key_begin_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.h
+//
+// Identification: src/include/storage/page/free_space_map_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ *
+ * Free space map page of a table heap. Every slot records how much room one table page has left, rounded down to a
+ * one byte category of CATEGORY_SIZE bytes each. The free space map pages of a table form a list.
+ *
+ * Page format (size in byte):
+ * -----------------------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId (4) | NextPageId (4) | Size (4) | Tree (2 * SLOTS - 1) | Free (1) | TablePageIds (4 * SLOTS)
+ * -----------------------------------------------------------------------------------------------------------
+ *
+ * The categories are the leaves of a binary max-tree in an array: node i has the children 2i+1 and 2i+2, and holds the
+ * largest category below it, so that the root holds the largest category of the page. Finding a slot with enough room
+ * and updating one only take a walk up and down the tree, instead of a scan of the slots.
+ */
+class FreeSpaceMapPage {
+ public:
+  /** The number of bytes of free space in one category. */
+  static constexpr uint32_t CATEGORY_SIZE = PAGE_SIZE / 256;
+  /** The number of table pages one free space map page records, a power of two that fits with its tree. */
+  static constexpr uint32_t SLOTS = [] {
+    uint32_t slots = 1;
+    while (4 * sizeof(uint32_t) + 2 * slots * (2 + sizeof(page_id_t)) <= PAGE_SIZE) {
+      slots *= 2;
+    }
+    return slots;
+  }();
+
+  /**
+   * Initializes an empty free space map page.
+   * @param page_id the page ID of this page
+   */
+  void Init(page_id_t page_id);
+
+  /** @return the page ID of this page */
+  page_id_t GetPageId() const;
+
+  /** @return the page ID of the next free space map page of the table, INVALID_PAGE_ID if this is the last one */
+  page_id_t GetNextPageId() const;
+
+  /** Sets the page ID of the next free space map page of the table. */
+  void SetNextPageId(page_id_t next_page_id);
+
+  /** @return the number of table pages recorded in this page */
+  uint32_t GetSize() const;
+
+  /** @return true if no more table pages can be recorded in this page */
+  bool IsFull() const;
+
+  /**
+   * Records a table page.
+   * @param table_page_id the page ID of the table page
+   * @param free_space the free space of the table page
+   * @return the slot the table page is recorded at
+   */
+  uint32_t Append(page_id_t table_page_id, uint32_t free_space);
+
+  /** @return the page ID of the table page recorded at slot */
+  page_id_t TablePageIdAt(uint32_t slot) const;
+
+  /** @return the category of the table page recorded at slot */
+  uint8_t CategoryAt(uint32_t slot) const;
+
+  /** @return the largest category of the table pages recorded in this page */
+  uint8_t GetMaxCategory() const;
+
+  /** Sets the free space of the table page recorded at slot. */
+  void SetFreeSpace(uint32_t slot, uint32_t free_space);
+
+  /**
+   * @param space the free space needed
+   * @param start the slot to start looking from
+   * @return the first slot from start on whose table page has at least space bytes free, wrapping around to the
+   * first slot, or SLOTS if there is none
+   */
+  uint32_t Find(uint32_t space, uint32_t start) const;
+
+  /** @return the category of a page with free_space bytes free; a page in category c has at least c * CATEGORY_SIZE */
+  static uint8_t Category(uint32_t free_space) {
+    return static_cast<uint8_t>(std::min<uint32_t>(free_space / CATEGORY_SIZE, UINT8_MAX));
+  }
+
+  /** @return the smallest category whose pages all have at least space bytes free, which may not fit into a byte */
+  static uint32_t RequiredCategory(uint32_t space) { return (space + CATEGORY_SIZE - 1) / CATEGORY_SIZE; }
+
+ private:
+  /** @return the first slot from start on with at least category, or SLOTS if there is none */
+  uint32_t FindFrom(uint32_t start, uint32_t category) const;
+
+  lsn_t lsn_;
+  page_id_t page_id_;
+  page_id_t next_page_id_;
+  uint32_t size_;
+  uint8_t tree_[2 * SLOTS];
+  page_id_t table_page_ids_[SLOTS];
+};
+
+}  // namespace bustub
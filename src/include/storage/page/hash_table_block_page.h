@@ -13,9 +13,14 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 #include "common/config.h"
 #include "storage/index/int_comparator.h"
 #include "storage/page/hash_table_page_defs.h"
@@ -32,6 +37,10 @@ namespace bustub {
  *
  *  Here '+' means concatenation.
  *
+ * Every index also has a one byte fingerprint, so that a probe compares the keys of the few pairs whose fingerprint
+ * matches the one of the key only. A readable index has the fingerprint of its key, which always has the high bit
+ * set; an index that was never occupied has EMPTY_FINGERPRINT and a tombstone TOMBSTONE_FINGERPRINT. The
+ * fingerprints are compared BLOCK_FINGERPRINT_GROUP at a time, with AVX2 if it is available.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class HashTableBlockPage {
@@ -64,11 +73,12 @@ class HashTableBlockPage {
    * @param bucket_ind index to write the key and value to
    * @param key key to insert
    * @param value value to insert
+   * @param fingerprint the fingerprint of the key, see Fingerprint
    * @return If the value is inserted successfully, it returns true. If the
    * index is marked as occupied before the key and value can be inserted,
    * Insert returns false.
    */
-  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value);
+  bool Insert(slot_offset_t bucket_ind, const KeyType &key, const ValueType &value, uint8_t fingerprint);
 
   /**
    * Removes a key and value at index.
@@ -93,11 +103,79 @@ class HashTableBlockPage {
    */
   bool IsReadable(slot_offset_t bucket_ind) const;
 
+  /**
+   * Scans the indexes of a range up to the first one that is not occupied, and visits the readable ones whose
+   * fingerprint matches.
+   *
+   * @param begin the first index to scan
+   * @param end the index after the last one to scan
+   * @param fingerprint the fingerprint of the key that is probed for
+   * @param visit called with each matching index in order, returns true to stop the scan
+   * @return the index visit stopped at, otherwise the first index that is not occupied, or end if all are
+   */
+  template <typename Visitor>
+  slot_offset_t ProbeFingerprints(slot_offset_t begin, slot_offset_t end, uint8_t fingerprint,
+                                  Visitor &&visit) const {
+    for (slot_offset_t group = begin - begin % BLOCK_FINGERPRINT_GROUP; group < end; group += BLOCK_FINGERPRINT_GROUP) {
+      // drop the indexes of the group that are out of the range
+      uint32_t window = ~uint32_t{0};
+      if (end - group < BLOCK_FINGERPRINT_GROUP) {
+        window = (uint32_t{1} << (end - group)) - 1;
+      }
+      if (begin > group) {
+        window &= ~((uint32_t{1} << (begin - group)) - 1);
+      }
+      uint32_t matches = MatchFingerprints(group, fingerprint) & window;
+      uint32_t empty = MatchFingerprints(group, EMPTY_FINGERPRINT) & window;
+      if (empty != 0) {
+        // the bits below the lowest empty index
+        matches &= (empty & -empty) - 1;
+      }
+      for (; matches != 0; matches &= matches - 1) {
+        slot_offset_t slot = group + __builtin_ctz(matches);
+        if (visit(slot)) {
+          return slot;
+        }
+      }
+      if (empty != 0) {
+        return group + __builtin_ctz(empty);
+      }
+    }
+    return end;
+  }
+
+  /**
+   * @param hash the hash of a key
+   * @return the fingerprint of the key, from the highest bits of its hash
+   */
+  static uint8_t Fingerprint(uint64_t hash) { return static_cast<uint8_t>(0x80 | (hash >> 57)); }
+
+  /** The fingerprint of an index that was never occupied, and of the padding after the last index. */
+  static constexpr uint8_t EMPTY_FINGERPRINT = 0;
+  /** The fingerprint of an index whose pair was removed. */
+  static constexpr uint8_t TOMBSTONE_FINGERPRINT = 1;
+
  private:
+  /** @return a bit for each index of the group of BLOCK_FINGERPRINT_GROUP indexes that has the fingerprint */
+  uint32_t MatchFingerprints(slot_offset_t group, uint8_t fingerprint) const {
+#ifdef __AVX2__
+    __m256i fingerprints = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints_ + group));
+    return static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(fingerprints, _mm256_set1_epi8(static_cast<char>(fingerprint)))));
+#else
+    uint32_t matches = 0;
+    for (int i = 0; i < BLOCK_FINGERPRINT_GROUP; i++) {
+      matches |= static_cast<uint32_t>(fingerprints_[group + i] == fingerprint) << i;
+    }
+    return matches;
+#endif
+  }
+
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   std::atomic_char readable_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
+  uint8_t fingerprints_[BLOCK_FINGERPRINTS_SIZE];
   MappingType array_[0];
 };
 
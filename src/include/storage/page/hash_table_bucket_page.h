@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_bucket_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/int_comparator.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Store indexed key and value together within a bucket page of an extendible hash table. Supports non-unique
+ * keys, but not the same pair twice.
+ *
+ * Bucket page format (pairs are stored in no particular order):
+ *  -------------------------------------------------------------------------------------------
+ * | NEXT PAGE ID (4) | READABLE BITS | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  -------------------------------------------------------------------------------------------
+ *
+ *  Here '+' means concatenation. Unlike in a block page of a linear probing hash table, no probe sequence runs
+ *  through a bucket, so a removed pair doesn't leave a tombstone and its index can be reused right away. The page is
+ *  latched by the caller.
+ *
+ *  A bucket whose pairs can't be split apart any further continues in overflow pages, which are bucket pages linked
+ *  by their NEXT PAGE ID.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class HashTableBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableBucketPage() = delete;
+
+  /**
+   * Initializes an empty bucket page without a next page.
+   */
+  void Init();
+
+  /**
+   * @return the page id of the next page of the bucket, INVALID_PAGE_ID if this is the last one
+   */
+  page_id_t GetNextPageId() const;
+
+  /**
+   * @param next_page_id the page id of the next page of the bucket
+   */
+  void SetNextPageId(page_id_t next_page_id);
+
+  /**
+   * Collects the values of all pairs with a key.
+   *
+   * @param key the key to look up
+   * @param cmp the comparator of keys
+   * @param[out] result the values of the key are appended here
+   * @return whether any pair has the key
+   */
+  bool GetValue(const KeyType &key, KeyComparator cmp, std::vector<ValueType> *result) const;
+
+  /**
+   * @return whether the bucket has the pair
+   */
+  bool Contains(const KeyType &key, const ValueType &value, KeyComparator cmp) const;
+
+  /**
+   * Inserts a pair into a free index of the bucket.
+   *
+   * @param key key to insert
+   * @param value value to insert
+   * @param cmp the comparator of keys
+   * @return false if the bucket already has the pair or is full, true otherwise
+   */
+  bool Insert(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Removes a pair from the bucket.
+   *
+   * @param key key to remove
+   * @param value value to remove
+   * @param cmp the comparator of keys
+   * @return whether the bucket had the pair
+   */
+  bool Remove(const KeyType &key, const ValueType &value, KeyComparator cmp);
+
+  /**
+   * Gets the key at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the key at
+   * @return key at index bucket_idx of the bucket
+   */
+  KeyType KeyAt(uint32_t bucket_idx) const;
+
+  /**
+   * Gets the value at an index in the bucket.
+   *
+   * @param bucket_idx the index in the bucket to get the value at
+   * @return value at index bucket_idx of the bucket
+   */
+  ValueType ValueAt(uint32_t bucket_idx) const;
+
+  /**
+   * Removes the pair at an index.
+   *
+   * @param bucket_idx index of the pair to remove
+   */
+  void RemoveAt(uint32_t bucket_idx);
+
+  /**
+   * Returns whether or not an index holds a pair
+   *
+   * @param bucket_idx index to look at
+   * @return true if the index is readable, false otherwise
+   */
+  bool IsReadable(uint32_t bucket_idx) const;
+
+  /**
+   * @return whether every index of the bucket holds a pair
+   */
+  bool IsFull() const;
+
+  /**
+   * @return whether no index of the bucket holds a pair
+   */
+  bool IsEmpty() const;
+
+  /**
+   * @return the number of pairs in the bucket
+   */
+  uint32_t NumReadable() const;
+
+ private:
+  page_id_t next_page_id_;
+  char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  MappingType array_[0];
+};
+
+}  // namespace bustub
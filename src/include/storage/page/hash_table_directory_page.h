@@ -0,0 +1,152 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_page.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Directory Page for extendible hash table.
+ *
+ * Directory format (size in byte):
+ * -----------------------------------------------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | LocalDepths(512) | BucketPageIds(2048) | DirectoryPageIds(1024) | Free(500)
+ * -----------------------------------------------------------------------------------------------------------------
+ *
+ * The lowest GlobalDepth bits of a hash are the index of its bucket in the directory. A bucket with local depth d is
+ * shared by the 2^(GlobalDepth - d) indexes that agree in their lowest d bits.
+ *
+ * A directory of more than DIRECTORY_ARRAY_SIZE indexes is spread over several directory pages: index i is slot
+ * i % DIRECTORY_ARRAY_SIZE of the (i / DIRECTORY_ARRAY_SIZE)-th page. The first page holds the GlobalDepth and the
+ * DirectoryPageIds of all pages of the directory, those fields of the other pages are unused.
+ */
+class HashTableDirectoryPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id for the page id field to be set to
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number for the lsn field to be set to
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the number of bits of a hash that index the directory
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @param global_depth the number of bits of a hash that index the directory
+   */
+  void SetGlobalDepth(uint32_t global_depth);
+
+  /**
+   * @return a mask of the lowest GlobalDepth bits, hash & mask is the directory index of the hash
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * @return the number of indexes of the directory
+   */
+  uint32_t Size() const;
+
+  /**
+   * @param directory_page_idx the number of a page of the directory
+   * @return the page id of the directory page
+   */
+  page_id_t GetDirectoryPageId(uint32_t directory_page_idx) const;
+
+  /**
+   * @param directory_page_idx the number of a page of the directory
+   * @param directory_page_id the page id of the directory page
+   */
+  void SetDirectoryPageId(uint32_t directory_page_idx, page_id_t directory_page_id);
+
+  /**
+   * @param slot the slot of an index in this page
+   * @return the page id of the bucket at the index
+   */
+  page_id_t GetBucketPageId(uint32_t slot) const;
+
+  /**
+   * @param slot the slot of an index in this page
+   * @param bucket_page_id the page id of the bucket at the index
+   */
+  void SetBucketPageId(uint32_t slot, page_id_t bucket_page_id);
+
+  /**
+   * @param slot the slot of an index in this page
+   * @return the local depth of the bucket at the index
+   */
+  uint32_t GetLocalDepth(uint32_t slot) const;
+
+  /**
+   * @param slot the slot of an index in this page
+   * @param local_depth the local depth of the bucket at the index
+   */
+  void SetLocalDepth(uint32_t slot, uint32_t local_depth);
+
+  /**
+   * Copies the bucket page ids and local depths of slots of a directory page, which may be this one, to slots of
+   * this page.
+   *
+   * @param from the directory page to copy from
+   * @param from_slot the first slot to copy
+   * @param to_slot the slot the first slot is copied to
+   * @param num_slots the number of slots to copy
+   */
+  void CopySlots(const HashTableDirectoryPage &from, uint32_t from_slot, uint32_t to_slot, uint32_t num_slots);
+
+  /** The largest number of pages of a directory. */
+  static constexpr uint32_t MAX_DIRECTORY_PAGES = 256;
+  /** The largest global depth, at which the directory fills MAX_DIRECTORY_PAGES pages. */
+  static constexpr uint32_t MAX_GLOBAL_DEPTH = 17;
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  uint32_t global_depth_;
+  uint8_t local_depths_[DIRECTORY_ARRAY_SIZE];
+  page_id_t bucket_page_ids_[DIRECTORY_ARRAY_SIZE];
+  page_id_t directory_page_ids_[MAX_DIRECTORY_PAGES];
+};
+
+static_assert(1 << HashTableDirectoryPage::MAX_GLOBAL_DEPTH ==
+              DIRECTORY_ARRAY_SIZE * HashTableDirectoryPage::MAX_DIRECTORY_PAGES);
+static_assert(sizeof(HashTableDirectoryPage) <= PAGE_SIZE);
+
+}  // namespace bustub
@@ -26,10 +26,12 @@ namespace bustub {
  *
  * Header Page for linear probing hash table.
  *
- * Header format (size in byte, 16 bytes in total):
- * -------------------------------------------------------------
- * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4)
- * -------------------------------------------------------------
+ * Header format (size in byte, 20 bytes in total):
+ * --------------------------------------------------------------------------
+ * | LSN (4) | Size (4) | PageId(4) | NextBlockIndex(4) | NextPageId(4)
+ * --------------------------------------------------------------------------
+ *
+ * A table with more blocks than one header page holds lists the rest in further header pages, linked by NextPageId.
  */
 class HashTableHeaderPage {
  public:
@@ -69,6 +71,18 @@ class HashTableHeaderPage {
    */
   void SetLSN(lsn_t lsn);
 
+  /**
+   * @return the page ID of the next header page of the table, INVALID_PAGE_ID if this is the last one
+   */
+  page_id_t GetNextPageId() const;
+
+  /**
+   * Sets the page ID of the next header page of the table
+   *
+   * @param next_page_id the page id of the next header page
+   */
+  void SetNextPageId(page_id_t next_page_id);
+
   /**
    * Adds a block page_id to the end of header page
    *
@@ -89,12 +103,27 @@ class HashTableHeaderPage {
    */
   size_t NumBlocks();
 
+  /**
+   * Removes all block page_ids from the header page, before the blocks of a resized table are added
+   */
+  void ClearBlockPageIds();
+
+  /**
+   * @return the number of block page_ids that fit into a header page
+   */
+  static constexpr size_t MaxNumBlocks();
+
  private:
-  __attribute__((unused)) lsn_t lsn_;
-  __attribute__((unused)) size_t size_;
-  __attribute__((unused)) page_id_t page_id_;
-  __attribute__((unused)) size_t next_ind_;
-  __attribute__((unused)) page_id_t block_page_ids_[0];
+  lsn_t lsn_;
+  size_t size_;
+  page_id_t page_id_;
+  size_t next_ind_;
+  page_id_t next_page_id_;
+  page_id_t block_page_ids_[0];
 };
 
+constexpr size_t HashTableHeaderPage::MaxNumBlocks() {
+  return (PAGE_SIZE - sizeof(HashTableHeaderPage)) / sizeof(page_id_t);
+}
+
 }  // namespace bustub
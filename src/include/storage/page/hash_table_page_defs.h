@@ -14,11 +14,28 @@
 
 #define MappingType std::pair<KeyType, ValueType>
 
-/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in   * a block page. It is an approximate
+/** BLOCK_ARRAY_SIZE is the number of (key, value) pairs that can be stored in a block page. It is an approximate
  * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
- * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
- * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+ * pair, we need two additional bits for occupied_ and readable_, and a byte for its fingerprint. 4 * PAGE_SIZE / (4 *
+ * sizeof (MappingType) + 5) = PAGE_SIZE/(sizeof (MappingType) + 1.25) because 1.25 bytes = 10 bits is the space
+ * required to maintain the occupied and readable flags and the fingerprint of a key value pair. 64 bytes of the page
+ * are kept for padding the fingerprints to whole SIMD registers and the pairs to their alignment.*/
+#define BLOCK_ARRAY_SIZE (4 * (PAGE_SIZE - 64) / (4 * sizeof(MappingType) + 5))
+
+/** The fingerprints of a block page are compared BLOCK_FINGERPRINT_GROUP at a time, BLOCK_FINGERPRINTS_SIZE is
+ * BLOCK_ARRAY_SIZE rounded up to whole groups. */
+#define BLOCK_FINGERPRINT_GROUP 32
+#define BLOCK_FINGERPRINTS_SIZE (((BLOCK_ARRAY_SIZE - 1) / BLOCK_FINGERPRINT_GROUP + 1) * BLOCK_FINGERPRINT_GROUP)
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
+
+/** BUCKET_ARRAY_SIZE is the number of (key, value) pairs that fit into a bucket page of an extendible hash table. A
+ * bucket page only keeps one readable bit per pair: 8 * PAGE_SIZE / (8 * sizeof (MappingType) + 1). 8 bytes of the
+ * page are kept for the page id of the next page of the bucket and for aligning the pairs. */
+#define BUCKET_ARRAY_SIZE (8 * (PAGE_SIZE - 8) / (8 * sizeof(MappingType) + 1))
+
+#define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
+
+/** DIRECTORY_ARRAY_SIZE is the number of bucket page ids of the directory page of an extendible hash table, each one
+ * with its local depth. It is the largest power of two that fits into a page. */
+#define DIRECTORY_ARRAY_SIZE 512
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 
@@ -49,10 +51,17 @@ class Page {
   inline bool IsDirty() { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,6 +69,23 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Optimistic readers read the page without latching it: they get its version first, read the data, and then check
+   * with ValidateVersion that no writer latched the page in between. The version is incremented when the write latch
+   * is acquired and again when it is released, so it is odd while a writer holds the page.
+   * @return the current version of the page
+   */
+  inline uint64_t GetVersion() { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * @param version a version returned by GetVersion
+   * @return true iff the page has not been write latched since that version was read
+   */
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -86,8 +112,14 @@ class Page {
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** True while the buffer pool manager is reading this page in or writing the previous page of the frame out. */
+  bool is_io_in_progress_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Version for optimistic readers, odd while the page is write latched or its frame is given to another page. */
+  std::atomic<uint64_t> version_{0};
+  /** Number of optimistic readers that keep the frame from being given to another page, see FetchPageOptimistic. */
+  std::atomic<int> optimistic_pins_{0};
 };
 
 }  // namespace bustub
@@ -40,6 +40,8 @@ namespace bustub {
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
  *
+ *  The first page of a table has no previous page, so its PrevPageId holds the page ID of the first page of the free
+ *  space map of the table instead.
  */
 class TablePage : public Page {
  public:
@@ -72,6 +74,12 @@ class TablePage : public Page {
     memcpy(GetData() + OFFSET_NEXT_PAGE_ID, &next_page_id, sizeof(page_id_t));
   }
 
+  /** @return the page ID of the first page of the free space map of the table, only valid on its first page */
+  page_id_t GetFreeSpaceMapPageId() { return GetPrevPageId(); }
+
+  /** Set the page id of the first page of the free space map of the table, only on its first page. */
+  void SetFreeSpaceMapPageId(page_id_t free_space_map_page_id) { SetPrevPageId(free_space_map_page_id); }
+
   /**
    * Insert a tuple into the table.
    * @param tuple tuple to insert
@@ -137,6 +145,17 @@ class TablePage : public Page {
    */
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
+  /** @return the free space left in this page for tuples and their slots */
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
+  /** @return the free space inserting tuple needs, when it does not reuse an empty slot */
+  static uint32_t GetSpaceNeeded(const Tuple &tuple) { return tuple.size_ + SIZE_TUPLE; }
+
+  /** @return the free space of an empty page */
+  static uint32_t GetMaxFreeSpace() { return PAGE_SIZE - SIZE_TABLE_PAGE_HEADER; }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
 
@@ -166,10 +185,6 @@ class TablePage : public Page {
   /** Set the number of tuples in this page. */
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   /** @return tuple offset at slot slot_num */
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/table/free_space_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <shared_mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/segment.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap records how much room every page of a table heap has left, so that an insert can go straight to a page
+ * with enough room instead of walking the page chain. The entries are stored in a list of FreeSpaceMapPages, in the
+ * order the table pages were recorded, which are allocated from the segment of the table.
+ *
+ * The largest category of every map page is kept in memory, so a lookup only fetches a map page that has room. It
+ * starts from the slot the previous lookup found, so that inserts fill one page after the other instead of all going
+ * to the first page with room.
+ */
+class FreeSpaceMap {
+ public:
+  /**
+   * Creates a free space map that is neither created nor attached yet.
+   * @param buffer_pool_manager the buffer pool manager
+   * @param segment the segment the map pages are allocated from
+   */
+  FreeSpaceMap(BufferPoolManager *buffer_pool_manager, Segment *segment)
+      : buffer_pool_manager_(buffer_pool_manager), segment_(segment) {}
+
+  /**
+   * Creates a new, empty map.
+   * @return the page ID of the first page of the map
+   */
+  page_id_t Create();
+
+  /**
+   * Attaches to a map stored in pages, reading its pages but none of the table pages.
+   * @param first_page_id the page ID of the first page of the map
+   */
+  void Attach(page_id_t first_page_id);
+
+  /**
+   * Records the free space of a table page, adding the page to the map if it is not in it yet.
+   * @param table_page_id the page ID of the table page
+   * @param free_space the free space of the table page
+   */
+  void Update(page_id_t table_page_id, uint32_t free_space);
+
+  /**
+   * @param space the free space needed
+   * @return the page ID of a table page with at least space bytes free, or INVALID_PAGE_ID if there is none
+   */
+  page_id_t FindPage(uint32_t space);
+
+  /** @return the page ID of the last table page added to the map, INVALID_PAGE_ID if the map is empty */
+  page_id_t GetLastTablePageId();
+
+ private:
+  /** @return the map page, pinned */
+  Page *FetchMapPage(page_id_t page_id);
+
+  /** Sets the free space of the table page at slot across all map pages. Must be called with latch_ held. */
+  void SetFreeSpace(uint32_t slot, uint32_t free_space);
+
+  BufferPoolManager *buffer_pool_manager_;
+  Segment *segment_;
+  /** Protects the layout of the map: its pages and the slots of the table pages. The map pages have their latches. */
+  std::shared_mutex latch_;
+  std::vector<page_id_t> map_page_ids_;
+  /** The largest category of every map page. */
+  std::deque<std::atomic<uint8_t>> max_categories_;
+  /** The page ID of every recorded table page, to its slot across all the map pages. */
+  std::unordered_map<page_id_t, uint32_t> slots_;
+  page_id_t last_table_page_id_{INVALID_PAGE_ID};
+  /** The slot the previous lookup found, where the next one starts. */
+  std::atomic<uint32_t> hint_{0};
+};
+
+}  // namespace bustub
@@ -12,9 +12,13 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
+#include "storage/disk/segment.h"
 #include "storage/page/table_page.h"
+#include "storage/table/free_space_map.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
@@ -22,7 +26,10 @@ namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
- * This is just a doubly-linked list of pages.
+ * This is just a doubly-linked list of pages. The pages are allocated from the table's own extents, so that the page
+ * chain is laid out sequentially on disk. Inserts find a page with enough room through the table's free space map,
+ * whose first page is recorded in the first table page. The map is attached on the first change to the table, and
+ * only built from the page chain when the table has none yet.
  */
 class TableHeap {
   friend class TableIterator;
@@ -99,8 +106,12 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn transaction performing the scan
+   * @param strategy buffer access strategy the iterator reads pages with, nullptr to read them through the shared pool
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -109,10 +120,25 @@ class TableHeap {
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
  private:
+  /**
+   * Attaches the free space map of the table, building it from the page chain if there is none, and finds the last
+   * page.
+   */
+  void AttachFreeSpaceMap();
+
+  /** Inserts a tuple into the last page, appending a new page to the chain if the last page is full. */
+  bool InsertTupleAtEnd(const Tuple &tuple, RID *rid, Transaction *txn);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  Segment segment_;
+  FreeSpaceMap free_space_map_;
+  std::once_flag free_space_map_attached_;
+  /** Serializes appending pages to the chain, and protects last_page_id_. */
+  std::mutex append_latch_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
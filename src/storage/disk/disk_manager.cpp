@@ -10,8 +10,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
 #include <cstring>
 #include <iostream>
 #include <string>
@@ -20,17 +24,79 @@
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/segment.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+/** The number of bytes of the free map that one free map page holds. */
+static constexpr size_t FREE_MAP_SLICE_SIZE = DiskManager::FREE_MAP_PAGE_CAPACITY / 8;
+
+/**
+ * Offset of the free map page of a group in the db file
+ */
+static int64_t GetFreeMapPageOffset(size_t group) {
+  return static_cast<int64_t>(group) * (DiskManager::FREE_MAP_PAGE_CAPACITY + 1) * PAGE_SIZE;
+}
+
+/**
+ * Write a whole page at the given offset of a file, retrying interrupted and partial writes
+ */
+static void WriteRawPage(int fd, int64_t offset, const char *page_data) {
+  size_t written = 0;
+  while (written < PAGE_SIZE) {
+    ssize_t rc = pwrite(fd, page_data + written, PAGE_SIZE - written, offset + written);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // check for I/O error
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += rc;
+  }
+}
+
+/**
+ * Read a whole page at the given offset of a file
+ * The part of the page that lies beyond the end of the file reads as zeros.
+ */
+static void ReadRawPage(int fd, int64_t offset, char *page_data) {
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(fd, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (rc == 0) {
+      // the file ends before the page does
+      LOG_DEBUG("Read less than a page");
+      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      return;
+    }
+    read_count += rc;
+  }
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), next_page_id_(0), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+    : db_fd_(-1),
+      file_name_(db_file),
+      next_page_id_(0),
+      num_flushes_(0),
+      num_writes_(0),
+      num_syncs_(0),
+      flush_log_(false),
+      flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -52,73 +118,83 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
-    }
+  // open or create the db file
+  db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  if (!LoadFreeMap()) {
+    close(db_fd_);
+    db_fd_ = -1;
+    throw Exception("db file has an unknown format");
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  ReleaseSegments();
+  if (db_fd_ >= 0) {
+    {
+      std::scoped_lock guard(free_map_latch_);
+      WriteFreeMap();
+    }
+    close(db_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  if (db_fd_ >= 0) {
+    ReleaseSegments();
+    SyncDatabase();
+    close(db_fd_);
+    db_fd_ = -1;
+  }
   log_io_.close();
 }
 
 /**
  * Write the contents of the specified page into disk file
+ * The write is positional, so it needs no cursor and runs concurrently with other page I/O.
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
-    return;
-  }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  WriteRawPage(db_fd_, GetPageOffset(page_id), page_data);
 }
 
 /**
  * Read the contents of the specified page into the given memory area
+ * The part of the page that lies beyond the end of the file reads as zeros.
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
-    }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+  ReadRawPage(db_fd_, GetPageOffset(page_id), page_data);
+}
+
+/**
+ * Sync the db file, so that the free map and every page write that has returned are durable
+ */
+void DiskManager::SyncDatabase() {
+  {
+    std::scoped_lock guard(free_map_latch_);
+    WriteFreeMap();
+  }
+  num_syncs_ += 1;
+  SyncFile();
+}
+
+/**
+ * Private helper function to sync the data of the db file
+ */
+void DiskManager::SyncFile() {
+#ifdef __linux__
+  int rc = fdatasync(db_fd_);
+#else
+  int rc = fsync(db_fd_);
+#endif
+  if (rc != 0) {
+    LOG_DEBUG("I/O error while syncing");
   }
 }
 
@@ -186,16 +262,133 @@ bool DiskManager::ReadLog(char *log_data, int size, int offset) {
 
 /**
  * Allocate new page (operations like create index/table)
- * For now just keep an increasing counter
+ * Reuse the free page with the lowest id, so that the file stays dense, and only grow the file if there is none
  */
-page_id_t DiskManager::AllocatePage() { return next_page_id_++; }
+page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock guard(free_map_latch_);
+  if (num_free_pages_ == 0) {
+    return next_page_id_++;
+  }
+
+  size_t byte = free_map_hint_ / 8;
+  while (free_map_[byte] == 0) {
+    byte++;
+  }
+  auto bits = static_cast<unsigned char>(free_map_[byte]);
+  auto page_id = static_cast<page_id_t>(byte * 8 + __builtin_ctz(bits));
+  free_map_[byte] = static_cast<char>(bits & (bits - 1));
+  free_map_dirty_[page_id / FREE_MAP_PAGE_CAPACITY] = true;
+  num_free_pages_--;
+  free_map_hint_ = page_id + 1;
+  PersistFreeMap();
+  return page_id;
+}
+
+/**
+ * Allocate an extent of contiguous pages (segments of tables and indexes)
+ * Reuse the lowest run of free pages that is long enough, and only grow the file if there is none
+ */
+page_id_t DiskManager::AllocateExtent(size_t num_pages) {
+  std::scoped_lock guard(free_map_latch_);
+  auto run_length = static_cast<page_id_t>(num_pages);
+  if (num_free_pages_ >= num_pages) {
+    page_id_t run_start = free_map_hint_;
+    for (page_id_t page_id = free_map_hint_; page_id < static_cast<page_id_t>(free_map_.size() * 8); page_id++) {
+      if ((free_map_[page_id / 8] & (1 << (page_id % 8))) == 0) {
+        run_start = page_id + 1;
+        continue;
+      }
+      if (page_id - run_start + 1 < run_length) {
+        continue;
+      }
+      for (page_id_t i = run_start; i <= page_id; i++) {
+        free_map_[i / 8] &= static_cast<char>(~(1 << (i % 8)));
+        free_map_dirty_[i / FREE_MAP_PAGE_CAPACITY] = true;
+      }
+      num_free_pages_ -= num_pages;
+      PersistFreeMap();
+      return run_start;
+    }
+  }
+
+  page_id_t first_page_id = next_page_id_;
+  next_page_id_ += run_length;
+  return first_page_id;
+}
+
+/**
+ * Register a segment, see ReleaseSegment
+ */
+void DiskManager::RegisterSegment(Segment *segment) {
+  std::scoped_lock guard(segments_latch_);
+  segments_.insert(segment);
+}
+
+/**
+ * Release a segment that goes away, so that the rest of its current extent can be allocated again
+ */
+void DiskManager::ReleaseSegment(Segment *segment) {
+  std::scoped_lock guard(segments_latch_);
+  if (segments_.erase(segment) > 0) {
+    FreeUnusedPages(segment);
+  }
+}
+
+/**
+ * Private helper function to release the segments that are still around when the disk manager shuts down
+ */
+void DiskManager::ReleaseSegments() {
+  std::scoped_lock guard(segments_latch_);
+  for (auto segment : segments_) {
+    FreeUnusedPages(segment);
+    segment->Detach();
+  }
+  segments_.clear();
+}
+
+/**
+ * Private helper function to deallocate the unused pages of a segment's current extent
+ */
+void DiskManager::FreeUnusedPages(Segment *segment) {
+  auto [begin, end] = segment->TakeUnusedPages();
+  for (page_id_t page_id = begin; page_id < end; page_id++) {
+    DeallocatePage(page_id);
+  }
+}
 
 /**
  * Deallocate page (operations like drop index/table)
- * Need bitmap in header page for tracking pages
- * This does not actually need to do anything for now.
+ * Mark the page as free in the free map, it is written back on the next sync
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock guard(free_map_latch_);
+  if (page_id < 0 || page_id >= next_page_id_) {
+    return;
+  }
+  size_t byte = page_id / 8;
+  auto mask = static_cast<char>(1 << (page_id % 8));
+  if (byte >= free_map_.size()) {
+    size_t num_groups = page_id / FREE_MAP_PAGE_CAPACITY + 1;
+    free_map_.resize(num_groups * FREE_MAP_SLICE_SIZE, 0);
+    free_map_dirty_.resize(num_groups, false);
+  }
+  if ((free_map_[byte] & mask) != 0) {
+    // already free
+    return;
+  }
+  free_map_[byte] |= mask;
+  free_map_dirty_[page_id / FREE_MAP_PAGE_CAPACITY] = true;
+  num_free_pages_++;
+  free_map_hint_ = std::min(free_map_hint_, page_id);
+}
+
+/**
+ * Returns number of free pages
  */
-void DiskManager::DeallocatePage(__attribute__((unused)) page_id_t page_id) {}
+size_t DiskManager::GetNumFreePages() {
+  std::scoped_lock guard(free_map_latch_);
+  return num_free_pages_;
+}
 
 /**
  * Returns number of flushes made so far
@@ -207,11 +400,94 @@ int DiskManager::GetNumFlushes() const { return num_flushes_; }
  */
 int DiskManager::GetNumWrites() const { return num_writes_; }
 
+/**
+ * Returns number of syncs of the db file made so far
+ */
+int DiskManager::GetNumSyncs() const { return num_syncs_; }
+
 /**
  * Returns true if the log is currently being flushed
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
+/**
+ * Private helper function to read the free map pages of the db file
+ * The allocated pages are the ones the file has room for; the pages past them were never written and the file does
+ * not hold them, so they count as unallocated even if they were allocated and freed before.
+ */
+bool DiskManager::LoadFreeMap() {
+  struct stat stat_buf;
+  int64_t file_size = fstat(db_fd_, &stat_buf) == 0 ? stat_buf.st_size : 0;
+  if (file_size == 0) {
+    // a new file, its first free map page marks the format before any page is written
+    next_page_id_ = 0;
+    free_map_.assign(FREE_MAP_SLICE_SIZE, 0);
+    free_map_dirty_.assign(1, true);
+    PersistFreeMap();
+    return true;
+  }
+
+  int64_t num_physical_pages = (file_size + PAGE_SIZE - 1) / PAGE_SIZE;
+  int64_t num_groups = (num_physical_pages + FREE_MAP_PAGE_CAPACITY) / (FREE_MAP_PAGE_CAPACITY + 1);
+  next_page_id_ = num_physical_pages - num_groups;
+
+  free_map_.assign(num_groups * FREE_MAP_SLICE_SIZE, 0);
+  free_map_dirty_.assign(num_groups, false);
+  char page[PAGE_SIZE];
+  for (int64_t group = 0; group < num_groups; group++) {
+    ReadRawPage(db_fd_, GetFreeMapPageOffset(group), page);
+    uint32_t magic;
+    memcpy(&magic, page, sizeof(magic));
+    // the free map pages of the other groups may not have been written yet, they read as all pages allocated then
+    if (group == 0 && magic != FREE_MAP_MAGIC) {
+      return false;
+    }
+    memcpy(free_map_.data() + group * FREE_MAP_SLICE_SIZE, page + FREE_MAP_HEADER_SIZE, FREE_MAP_SLICE_SIZE);
+  }
+
+  num_free_pages_ = 0;
+  free_map_hint_ = 0;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(free_map_.size() * 8); page_id++) {
+    auto mask = static_cast<char>(1 << (page_id % 8));
+    if ((free_map_[page_id / 8] & mask) == 0) {
+      continue;
+    }
+    if (page_id >= next_page_id_) {
+      free_map_[page_id / 8] &= ~mask;
+      free_map_dirty_[page_id / FREE_MAP_PAGE_CAPACITY] = true;
+      continue;
+    }
+    num_free_pages_++;
+  }
+  return true;
+}
+
+/**
+ * Private helper function to write the free map pages that changed back to the db file
+ */
+void DiskManager::WriteFreeMap() {
+  char page[PAGE_SIZE];
+  for (size_t group = 0; group < free_map_dirty_.size(); group++) {
+    if (!free_map_dirty_[group]) {
+      continue;
+    }
+    auto group_index = static_cast<uint32_t>(group);
+    memcpy(page, &FREE_MAP_MAGIC, sizeof(FREE_MAP_MAGIC));
+    memcpy(page + sizeof(FREE_MAP_MAGIC), &group_index, sizeof(group_index));
+    memcpy(page + FREE_MAP_HEADER_SIZE, free_map_.data() + group * FREE_MAP_SLICE_SIZE, FREE_MAP_SLICE_SIZE);
+    WriteRawPage(db_fd_, GetFreeMapPageOffset(group), page);
+    free_map_dirty_[group] = false;
+  }
+}
+
+/**
+ * Private helper function to make the free map pages that changed durable
+ */
+void DiskManager::PersistFreeMap() {
+  WriteFreeMap();
+  SyncFile();
+}
+
 /**
  * Private helper function to get disk file size
  */
@@ -0,0 +1,388 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+/** Number of threads of the thread pool backend. */
+static constexpr size_t THREAD_POOL_SIZE = 4;
+
+/** Number of operations the io_uring probe has room for. */
+static constexpr unsigned IO_URING_PROBE_OPS = 256;
+
+#ifdef __linux__
+static int IoUringSetup(unsigned entries, io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int IoUringRegister(int ring_fd, unsigned opcode, void *arg, unsigned nr_args) {
+  return static_cast<int>(syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+struct DiskScheduler::IoUring {
+  ~IoUring() {
+    if (sqes_ != MAP_FAILED) {
+      munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+      munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+      munmap(sq_ptr_, sq_size_);
+    }
+    if (ring_fd_ >= 0) {
+      close(ring_fd_);
+    }
+  }
+
+  int ring_fd_{-1};
+  void *sq_ptr_{MAP_FAILED};
+  size_t sq_size_{0};
+  void *cq_ptr_{MAP_FAILED};
+  size_t cq_size_{0};
+  void *sqes_{MAP_FAILED};
+  size_t sqes_size_{0};
+
+  // submission queue, the kernel consumes entries at head and we produce them at tail
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  // completion queue, the kernel produces entries at tail and we consume them at head
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+
+  /** Requests in flight, indexed by the user data of their submission queue entries. */
+  std::vector<DiskRequest> slots_;
+  /** Indexes of the unused slots. */
+  std::vector<uint64_t> free_slots_;
+};
+#else
+// io_uring is Linux only, elsewhere the thread pool backend is always used
+struct DiskScheduler::IoUring {};
+#endif
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t queue_depth, Backend backend)
+    : disk_manager_(disk_manager), queue_depth_(std::max<size_t>(queue_depth, 1)), backend_(backend) {
+  if (backend_ == Backend::IO_URING && (disk_manager_->GetDatabaseFd() < 0 || !SetUpIoUring())) {
+    ring_.reset();
+    backend_ = Backend::THREAD_POOL;
+  }
+
+  if (backend_ == Backend::IO_URING) {
+    threads_.emplace_back(&DiskScheduler::RunIoUring, this);
+  } else {
+    for (size_t i = 0; i < std::min(queue_depth_, THREAD_POOL_SIZE); i++) {
+      threads_.emplace_back(&DiskScheduler::RunThreadPoolWorker, this);
+    }
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock guard(latch_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  {
+    std::scoped_lock guard(latch_);
+    queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> requests) {
+  {
+    std::scoped_lock guard(latch_);
+    for (auto &request : requests) {
+      queue_.push_back(std::move(request));
+    }
+  }
+  cv_.notify_all();
+}
+
+std::future<bool> DiskScheduler::ScheduleRead(page_id_t page_id, char *page_data) {
+  DiskRequest request{false, page_data, page_id, std::promise<bool>(), nullptr};
+  auto future = request.callback_.get_future();
+  Schedule(std::move(request));
+  return future;
+}
+
+std::future<bool> DiskScheduler::ScheduleWrite(page_id_t page_id, const char *page_data) {
+  // the data is only read from, the request type is shared with reads
+  DiskRequest request{true, const_cast<char *>(page_data), page_id, std::promise<bool>(), nullptr};
+  auto future = request.callback_.get_future();
+  Schedule(std::move(request));
+  return future;
+}
+
+void DiskScheduler::Complete(DiskRequest *request, bool success) {
+  if (request->on_complete_) {
+    request->on_complete_(success);
+  }
+  request->callback_.set_value(success);
+}
+
+void DiskScheduler::Perform(DiskRequest *request) {
+  if (request->is_write_) {
+    disk_manager_->WritePage(request->page_id_, request->data_);
+  } else {
+    disk_manager_->ReadPage(request->page_id_, request->data_);
+  }
+  Complete(request, true);
+}
+
+#ifdef __linux__
+bool DiskScheduler::SetUpIoUring() {
+  ring_ = std::make_unique<IoUring>();
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  ring_->ring_fd_ = IoUringSetup(queue_depth_, &params);
+  if (ring_->ring_fd_ < 0) {
+    LOG_DEBUG("io_uring is not available, falling back to a thread pool");
+    return false;
+  }
+
+  // Kernels before 5.6 set up a ring but fail every IORING_OP_READ and IORING_OP_WRITE with EINVAL. The probe came
+  // with these operations, so a kernel that cannot be probed does not have them either.
+  std::vector<char> probe_buffer(sizeof(io_uring_probe) + IO_URING_PROBE_OPS * sizeof(io_uring_probe_op), 0);
+  auto *probe = reinterpret_cast<io_uring_probe *>(probe_buffer.data());
+  if (IoUringRegister(ring_->ring_fd_, IORING_REGISTER_PROBE, probe, IO_URING_PROBE_OPS) < 0) {
+    LOG_DEBUG("io_uring cannot be probed, falling back to a thread pool");
+    return false;
+  }
+  for (unsigned opcode : {IORING_OP_READ, IORING_OP_WRITE}) {
+    if (opcode > probe->last_op || (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED) == 0) {
+      LOG_DEBUG("io_uring does not support reads and writes, falling back to a thread pool");
+      return false;
+    }
+  }
+
+  ring_->sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring_->cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    ring_->sq_size_ = ring_->cq_size_ = std::max(ring_->sq_size_, ring_->cq_size_);
+  }
+  ring_->sq_ptr_ = mmap(nullptr, ring_->sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_->ring_fd_, IORING_OFF_SQ_RING);
+  if (ring_->sq_ptr_ == MAP_FAILED) {
+    return false;
+  }
+  if (single_mmap) {
+    ring_->cq_ptr_ = ring_->sq_ptr_;
+  } else {
+    ring_->cq_ptr_ = mmap(nullptr, ring_->cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_->ring_fd_, IORING_OFF_CQ_RING);
+    if (ring_->cq_ptr_ == MAP_FAILED) {
+      return false;
+    }
+  }
+  ring_->sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  ring_->sqes_ = mmap(nullptr, ring_->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_->ring_fd_, IORING_OFF_SQES);
+  if (ring_->sqes_ == MAP_FAILED) {
+    return false;
+  }
+
+  auto *sq = static_cast<char *>(ring_->sq_ptr_);
+  ring_->sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  ring_->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring_->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring_->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(ring_->cq_ptr_);
+  ring_->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring_->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring_->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  ring_->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+  // the kernel may round the number of entries up, but we never have more than queue_depth_ requests in flight
+  ring_->slots_.resize(queue_depth_);
+  for (size_t i = 0; i < queue_depth_; i++) {
+    ring_->free_slots_.push_back(queue_depth_ - 1 - i);
+  }
+  return true;
+}
+
+void DiskScheduler::RunIoUring() {
+  IoUring &ring = *ring_;
+  auto *sqes = static_cast<io_uring_sqe *>(ring.sqes_);
+  size_t num_in_flight = 0;
+  std::vector<DiskRequest> batch;
+  while (true) {
+    bool more_queued;
+    {
+      std::unique_lock<std::mutex> guard(latch_);
+      if (num_in_flight == 0) {
+        cv_.wait(guard, [&] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          break;
+        }
+      }
+      while (!queue_.empty() && num_in_flight + batch.size() < queue_depth_) {
+        batch.push_back(std::move(queue_.front()));
+        queue_.pop_front();
+      }
+      more_queued = !queue_.empty();
+    }
+
+    // Fill in a submission queue entry per request. Only this thread writes the tail, so it can be read plainly.
+    unsigned tail = *ring.sq_tail_;
+    unsigned mask = *ring.sq_mask_;
+    for (auto &request : batch) {
+      int fd = disk_manager_->GetDatabaseFd();
+      if (fd < 0) {
+        Complete(&request, false);
+        continue;
+      }
+      uint64_t slot = ring.free_slots_.back();
+      ring.free_slots_.pop_back();
+      io_uring_sqe *sqe = &sqes[tail & mask];
+      memset(sqe, 0, sizeof(*sqe));
+      sqe->opcode = request.is_write_ ? IORING_OP_WRITE : IORING_OP_READ;
+      sqe->fd = fd;
+      sqe->addr = reinterpret_cast<uint64_t>(request.data_);
+      sqe->len = PAGE_SIZE;
+      sqe->off = DiskManager::GetPageOffset(request.page_id_);
+      sqe->user_data = slot;
+      ring.sq_array_[tail & mask] = tail & mask;
+      tail++;
+      ring.slots_[slot] = std::move(request);
+      num_in_flight++;
+    }
+    batch.clear();
+    // publish the entries before the new tail
+    __atomic_store_n(ring.sq_tail_, tail, __ATOMIC_RELEASE);
+
+    // Submit whatever the kernel has not consumed yet. Block for a completion unless there is more to submit.
+    unsigned to_submit = tail - __atomic_load_n(ring.sq_head_, __ATOMIC_ACQUIRE);
+    unsigned min_complete = (num_in_flight > 0 && (!more_queued || num_in_flight == queue_depth_)) ? 1 : 0;
+    if ((to_submit > 0 || min_complete > 0) &&
+        IoUringEnter(ring.ring_fd_, to_submit, min_complete, IORING_ENTER_GETEVENTS) < 0) {
+      if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+        // the ring is unusable, perform the requests synchronously from now on
+        LOG_WARN("io_uring_enter failed, falling back to synchronous I/O: %s", strerror(errno));
+        AbandonIoUring(tail, &num_in_flight);
+        backend_ = Backend::THREAD_POOL;
+        RunThreadPoolWorker();
+        return;
+      }
+      if (errno != EINTR) {
+        // out of kernel resources, or the completion queue is full: reap what there is and give the kernel a moment
+        std::this_thread::yield();
+      }
+    }
+    ReapIoUring(&num_in_flight);
+  }
+}
+
+void DiskScheduler::ReapIoUring(size_t *num_in_flight) {
+  IoUring &ring = *ring_;
+  unsigned head = *ring.cq_head_;
+  unsigned cq_tail = __atomic_load_n(ring.cq_tail_, __ATOMIC_ACQUIRE);
+  while (head != cq_tail) {
+    io_uring_cqe *cqe = &ring.cqes_[head & *ring.cq_mask_];
+    DiskRequest &request = ring.slots_[cqe->user_data];
+    int res = cqe->res;
+    bool success = res >= 0;
+    if (!success) {
+      LOG_WARN("I/O error on page %d: %s", request.page_id_, strerror(-res));
+    } else if (res < PAGE_SIZE) {
+      if (request.is_write_) {
+        // short writes are rare, finish them synchronously
+        disk_manager_->WritePage(request.page_id_, request.data_);
+      } else {
+        // the file ends before the page does
+        memset(request.data_ + res, 0, PAGE_SIZE - res);
+      }
+    } else if (request.is_write_) {
+      // DiskManager::WritePage counts the writes of the thread pool and the short writes
+      disk_manager_->num_writes_ += 1;
+    }
+    Complete(&request, success);
+    ring.slots_[cqe->user_data] = DiskRequest();
+    ring.free_slots_.push_back(cqe->user_data);
+    (*num_in_flight)--;
+    head++;
+  }
+  __atomic_store_n(ring.cq_head_, head, __ATOMIC_RELEASE);
+}
+
+void DiskScheduler::AbandonIoUring(unsigned sq_tail, size_t *num_in_flight) {
+  IoUring &ring = *ring_;
+  auto *sqes = static_cast<io_uring_sqe *>(ring.sqes_);
+  // without a polling kernel thread the kernel only takes entries in io_uring_enter, so the ones it has not taken yet
+  // stay ours and are performed here
+  unsigned sq_head = __atomic_load_n(ring.sq_head_, __ATOMIC_ACQUIRE);
+  for (unsigned i = sq_head; i != sq_tail; i++) {
+    uint64_t slot = sqes[ring.sq_array_[i & *ring.sq_mask_]].user_data;
+    Perform(&ring.slots_[slot]);
+    ring.slots_[slot] = DiskRequest();
+    ring.free_slots_.push_back(slot);
+    (*num_in_flight)--;
+  }
+  __atomic_store_n(ring.sq_tail_, sq_head, __ATOMIC_RELEASE);
+  // the kernel completes the others on its own
+  while (*num_in_flight > 0) {
+    ReapIoUring(num_in_flight);
+    std::this_thread::yield();
+  }
+}
+#else
+bool DiskScheduler::SetUpIoUring() { return false; }
+
+void DiskScheduler::RunIoUring() {}
+#endif
+
+void DiskScheduler::RunThreadPoolWorker() {
+  while (true) {
+    DiskRequest request;
+    {
+      std::unique_lock<std::mutex> guard(latch_);
+      cv_.wait(guard, [&] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        break;
+      }
+      request = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    Perform(&request);
+  }
+}
+
+}  // namespace bustub
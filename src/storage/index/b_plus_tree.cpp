@@ -9,7 +9,11 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cmath>
+#include <numeric>
 #include <string>
+#include <thread>  // NOLINT
 #include <type_traits>
 
 #include "common/exception.h"
@@ -45,13 +49,15 @@ void BPLUSTREE_TYPE::LatchRecord::Unlatch() {
 
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool b_link, bool slotted)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      b_link_(b_link),
+      slotted_(slotted) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -72,8 +78,33 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
     return false;
   }
 
+  // an optimistic descent doesn't move right, so a B-link tree always latches
+  for (int attempt = 0; attempt < (b_link_ ? 0 : OPTIMISTIC_ATTEMPTS); attempt++) {
+    Page *page;
+    uint64_t version;
+    if (!OptimisticFindLeafPage(&key, false, false, &page, &version)) {
+      continue;
+    }
+    if (page == nullptr) {
+      return false;
+    }
+    ValueType value;
+    auto ret = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+    // the lookup may have seen a half modified leaf, its result only counts if no writer got to the leaf meanwhile
+    bool valid = page->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPageOptimistic(page);
+    if (valid) {
+      if (ret) {
+        result->resize(1);
+        result->operator[](0) = value;
+      }
+      return ret;
+    }
+  }
+
+  // too many conflicts with writers, latch the pages instead
   Page *page = FindLeafPage(key, false);
-  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page);
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
 
   ValueType value;
   auto ret = leaf_page->Lookup(key, &value, comparator_);
@@ -87,6 +118,87 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
   return ret;
 }
 
+/*
+ * Return the values of many keys, see the declaration. The keys below the latched parent and leaf are bounded by the
+ * separator keys on the path to them, so a key that is not less than the bound continues at another child of the
+ * parent or, past the parent too, with a new descent from the root. Latches are only taken top-down and one leaf at a
+ * time, like a single lookup does.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::GetValues(const std::vector<KeyType> &keys, std::vector<std::vector<ValueType>> *result,
+                               Transaction *transaction) {
+  result->assign(keys.size(), std::vector<ValueType>());
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&](size_t lhs, size_t rhs) { return comparator_(keys[lhs], keys[rhs]) < 0; });
+
+  auto release = [&](Page **page) {
+    if (*page != nullptr) {
+      (*page)->RUnlatch();
+      buffer_pool_manager_->UnpinPage((*page)->GetPageId(), false);
+      *page = nullptr;
+    }
+  };
+  Page *parent = nullptr;
+  KeyType parent_upper;
+  bool parent_bounded = false;
+  Page *leaf = nullptr;
+  KeyType leaf_upper;
+  bool leaf_bounded = false;
+
+  for (size_t i : order) {
+    const KeyType &key = keys[i];
+    if (leaf != nullptr && leaf_bounded && comparator_(key, leaf_upper) >= 0) {
+      release(&leaf);
+    }
+    if (leaf == nullptr) {
+      if (parent != nullptr && parent_bounded && comparator_(key, parent_upper) >= 0) {
+        release(&parent);
+      }
+      if (parent == nullptr) {
+        parent = FindLeafParentPage(key, &parent_upper, &parent_bounded);
+        if (parent == nullptr) {
+          break;
+        }
+        if (reinterpret_cast<BPlusTreePage *>(parent->GetData())->IsLeafPage()) {
+          // the root is the only leaf
+          leaf = parent;
+          parent = nullptr;
+          leaf_bounded = false;
+        }
+      }
+      if (leaf == nullptr) {
+        auto *parent_page = reinterpret_cast<InternalPage *>(parent->GetData());
+        int child_index = parent_page->LookupIndex(key, comparator_);
+        leaf = buffer_pool_manager_->FetchPage(parent_page->ValueAt(child_index));
+        if (leaf == nullptr) {
+          release(&parent);
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::GetValues out of memory");
+        }
+        leaf->RLatch();
+        leaf_bounded = child_index + 1 < parent_page->GetSize() || parent_bounded;
+        leaf_upper = child_index + 1 < parent_page->GetSize() ? parent_page->KeyAt(child_index + 1) : parent_upper;
+      }
+    }
+
+    if (b_link_) {
+      // the parent may not know about a split of the leaf yet, the leaf's own high key is the exact bound
+      leaf = MoveRight(leaf, &key, false);
+      auto *leaf_page = reinterpret_cast<LeafPage *>(leaf->GetData());
+      leaf_bounded = leaf_page->GetNextPageId() != INVALID_PAGE_ID;
+      leaf_upper = leaf_page->GetHighKey();
+    }
+
+    ValueType value;
+    if (reinterpret_cast<LeafPage *>(leaf->GetData())->Lookup(key, &value, comparator_)) {
+      (*result)[i].push_back(value);
+    }
+  }
+  release(&leaf);
+  release(&parent);
+}
+
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
@@ -94,16 +206,61 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: the keys of the tree are unique, so if user try to insert duplicate
+ * keys return false, otherwise return true. A non-unique index stores duplicate
+ * keys with the RID suffix of their row, which keeps them unique in the tree.
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
   if (IsEmpty() && StartNewTree(key, value)) {
     return true;
   }
+  if (AppendToRightmostLeaf(key, value)) {
+    return true;
+  }
+  if (b_link_) {
+    return BLinkInsert(key, value);
+  }
   return InsertIntoLeaf(key, value, transaction);
 }
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CountAppend(const LeafPage *leaf_page, const KeyType &key) {
+  bool append = leaf_page->GetNextPageId() == INVALID_PAGE_ID &&
+                comparator_(leaf_page->KeyAt(leaf_page->GetSize() - 1), key) == 0;
+  // the counter is only written when it changes, so that concurrent inserts don't contend for it all the time
+  int appends = appends_.load(std::memory_order_relaxed);
+  if (append && appends < APPEND_THRESHOLD) {
+    appends_.fetch_add(1, std::memory_order_relaxed);
+  } else if (!append && appends > 0) {
+    appends_.store(0, std::memory_order_relaxed);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::AppendToRightmostLeaf(const KeyType &key, const ValueType &value) {
+  page_id_t page_id = rightmost_leaf_.load();
+  if (page_id == INVALID_PAGE_ID || appends_.load(std::memory_order_relaxed) < APPEND_THRESHOLD) {
+    return false;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  page->WLatch();
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  // a split or merge of the leaf changes the cached page id before the leaf is unlatched, and a page is only freed
+  // after it has been merged, so the page is still the right-most leaf of the tree if the cached page id is unchanged
+  bool append = rightmost_leaf_.load() == page_id && leaf_page->GetNextPageId() == INVALID_PAGE_ID &&
+                leaf_page->GetSize() > 0 && leaf_page->GetSize() < leaf_page->GetMaxSize() - 1 &&
+                comparator_(leaf_page->KeyAt(leaf_page->GetSize() - 1), key) < 0;
+  if (append) {
+    leaf_page->Append(key, value);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, append);
+  return append;
+}
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -113,7 +270,7 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
   page_id_t page_id;
-  if (Page *root = buffer_pool_manager_->NewPage(&page_id); root != nullptr) {
+  if (Page *root = buffer_pool_manager_->NewPageInSegment(&page_id, &segment_); root != nullptr) {
     root->WLatch();
     page_id_t expected = INVALID_PAGE_ID;
     if (!root_page_id_.compare_exchange_strong(expected, page_id)) {
@@ -125,8 +282,9 @@ bool BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
     UpdateRootPageId(true);
 
     LeafPage *tree_page = reinterpret_cast<LeafPage *>(root->GetData());
-    tree_page->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_);
+    tree_page->Init(root_page_id_, INVALID_PAGE_ID, leaf_max_size_, slotted_);
     tree_page->Insert(key, value, comparator_);
+    rightmost_leaf_.store(page_id);
     root->WUnlatch();
     buffer_pool_manager_->UnpinPage(root_page_id_, true);
     return true;
@@ -149,8 +307,8 @@ void BPLUSTREE_TYPE::RegistryUnlatchAndUnpin(bool is_dirty) {
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exist, return
  * immdiately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if user try to insert a duplicate key return false, otherwise
+ * return true (see Insert).
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
@@ -163,8 +321,11 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
     if (auto current_size = leaf_page->GetSize(); current_size < leaf_page->GetMaxSize() - 1) {
       // try to insert if the page does not need to split after insertion
       ret = leaf_page->Insert(key, value, comparator_) > current_size;
+      if (ret == 1) {
+        CountAppend(leaf_page, key);
+      }
     } else if (int idx = leaf_page->KeyIndex(key, this->comparator_);
-               this->comparator_(key, leaf_page->KeyAt(idx)) == 0) {
+               idx < current_size && this->comparator_(key, leaf_page->KeyAt(idx)) == 0) {
       // key already exists
       ret = 0;
     }
@@ -191,8 +352,9 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   }
 
   leaf_page->Insert(key, value, comparator_);
+  CountAppend(leaf_page, key);
   LeafPage *new_page = Split(leaf_page);
-  InsertIntoParent(leaf_page, new_page->KeyAt(0), new_page);
+  InsertIntoParent(leaf_page, leaf_page->GetHighKey(), new_page);
 
   reinterpret_cast<Page *>(new_page)->WUnlatch();
   buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
@@ -202,6 +364,114 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
   return true;
 }
 
+/*
+ * Insert into the leaf in B-link mode: only the leaf is write latched. If it splits, the leaf and its new sibling are
+ * released before the separator goes into the parent.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BLinkInsert(const KeyType &key, const ValueType &value) {
+  std::vector<page_id_t> path;
+  Page *page = BLinkFindLeafPage(&key, false, true, &path);
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+
+  int size = leaf_page->GetSize();
+  if (leaf_page->Insert(key, value, comparator_) == size) {
+    // key already exists
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    return false;
+  }
+  CountAppend(leaf_page, key);
+  if (leaf_page->GetSize() < leaf_page->GetMaxSize()) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    return true;
+  }
+
+  LeafPage *new_page = Split(leaf_page);
+  KeyType separator = leaf_page->GetHighKey();
+  page_id_t page_id = page->GetPageId();
+  page_id_t new_page_id = new_page->GetPageId();
+  reinterpret_cast<Page *>(new_page)->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+
+  BLinkInsertIntoParent(page_id, separator, new_page_id, 0, &path);
+  return true;
+}
+
+/*
+ * Insert the separator of a split node into the parent in B-link mode. The parent is found through the path of the
+ * descent, moving right from there since it may have split meanwhile. If the path is used up, the node was the root
+ * when the descent passed it: either it still is and gets a new root above it, or another writer has added a new
+ * root since, and the path is looked up again from there.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BLinkInsertIntoParent(page_id_t node_page_id, KeyType key, page_id_t new_page_id, size_t level,
+                                           std::vector<page_id_t> *path) {
+  while (true) {
+    if (path->empty()) {
+      std::unique_lock<std::mutex> lock(root_latch_);
+      if (root_page_id_.load() == node_page_id) {
+        page_id_t new_root_page_id;
+        Page *page = buffer_pool_manager_->NewPageInSegment(&new_root_page_id, &segment_);
+        if (page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::BLinkInsertIntoParent out of memory");
+        }
+        page->WLatch();
+        auto *root_page = reinterpret_cast<InternalPage *>(page->GetData());
+        root_page->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_, slotted_);
+        root_page->PopulateNewRoot(node_page_id, key, new_page_id);
+        root_page_id_.store(new_root_page_id);
+        UpdateRootPageId(false);
+        page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(new_root_page_id, true);
+        return;
+      }
+      lock.unlock();
+
+      std::vector<page_id_t> root_path;
+      Page *leaf = BLinkFindLeafPage(&key, false, false, &root_path);
+      leaf->RUnlatch();
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+      if (root_path.size() <= level) {
+        // the writer that split the old root hasn't added the new root above this level yet
+        std::this_thread::yield();
+        continue;
+      }
+      path->assign(root_path.begin(), root_path.end() - level);
+    }
+
+    page_id_t parent_page_id = path->back();
+    path->pop_back();
+    Page *page = buffer_pool_manager_->FetchPage(parent_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::BLinkInsertIntoParent out of memory");
+    }
+    page->WLatch();
+    page = MoveRight(page, &key, true);
+    auto *parent_page = reinterpret_cast<InternalPage *>(page->GetData());
+    // the parent may not know the split node yet either, so the separator goes in by key
+    parent_page->InsertNode(key, new_page_id, comparator_);
+    if (parent_page->GetSize() < parent_page->GetMaxSize()) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+      return;
+    }
+
+    InternalPage *sibling_page = Split(parent_page);
+    key = sibling_page->KeyAt(0);
+    node_page_id = parent_page->GetPageId();
+    new_page_id = sibling_page->GetPageId();
+    level++;
+    reinterpret_cast<Page *>(sibling_page)->WUnlatch();
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(node_page_id, true);
+  }
+}
+
 /*
  * Split input page and return newly created page.
  * Using template N to represent either internal page or leaf page.
@@ -213,23 +483,51 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
   page_id_t page_id;
-  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  Page *page = buffer_pool_manager_->NewPageInSegment(&page_id, &segment_);
   if (page == nullptr) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::Split out of memory");
   }
   page->WLatch();
 
   N *sibling = reinterpret_cast<N *>(page->GetData());
-  sibling->Init(page_id, node->GetParentPageId(), node->GetMaxSize());
+  KeyType separator;
+  bool rightmost = node->GetNextPageId() == INVALID_PAGE_ID;
+  // with appends, the right-most node of a level only gets pairs at its end; it keeps most of its pairs, since it won't
+  // get any more, and the new node keeps room for the next ones
+  bool append = rightmost && appends_.load(std::memory_order_relaxed) >= APPEND_THRESHOLD;
 
   // NOLINTNEXTLINE
   if constexpr (std::is_same_v<N, LeafPage>) {
-    node->MoveHalfTo(sibling);
-    sibling->SetNextPageId(node->GetNextPageId());
-    node->SetNextPageId(page_id);
+    sibling->Init(page_id, node->GetParentPageId(), leaf_max_size_, slotted_);
+    if (append) {
+      node->MoveTailTo(sibling, node->GetSize() - std::max(node->GetSize() / 10, 1));
+    } else {
+      node->MoveHalfTo(sibling);
+    }
+    if (rightmost) {
+      rightmost_leaf_.store(page_id);
+    }
+    separator = sibling->KeyAt(0);
+    if (slotted_) {
+      // any key between the two leaves separates them, the shortest one takes the least room in the parent
+      separator = SlottedKeys<KeyType, ValueType>::Separator(node->KeyAt(node->GetSize() - 1), separator, comparator_);
+    }
   } else {  // NOLINT
-    node->MoveHalfTo(sibling, buffer_pool_manager_);
+    sibling->Init(page_id, node->GetParentPageId(), internal_max_size_, slotted_);
+    // a B-link tree doesn't keep the parent page ids of the children up to date
+    BufferPoolManager *buffer_pool_manager = b_link_ ? nullptr : buffer_pool_manager_;
+    if (append) {
+      // an internal node needs two children
+      node->MoveTailTo(sibling, node->GetSize() - std::max(node->GetSize() / 10, 2), buffer_pool_manager);
+    } else {
+      node->MoveHalfTo(sibling, buffer_pool_manager);
+    }
+    separator = sibling->KeyAt(0);
   }
+  sibling->SetNextPageId(node->GetNextPageId());
+  sibling->SetHighKey(node->GetHighKey());
+  node->SetNextPageId(page_id);
+  node->SetHighKey(separator);
 
   return sibling;
 }
@@ -250,14 +548,14 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
 
   if (parent_page_id == INVALID_PAGE_ID) {
     page_id_t new_root_page_id;
-    Page *page = buffer_pool_manager_->NewPage(&new_root_page_id);
+    Page *page = buffer_pool_manager_->NewPageInSegment(&new_root_page_id, &segment_);
     if (page == nullptr) {
       throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::InsertIntoParent out of memory");
     }
 
     page->WLatch();
     InternalPage *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
-    internal_page->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    internal_page->Init(new_root_page_id, INVALID_PAGE_ID, internal_max_size_, slotted_);
     internal_page->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId());
 
     old_node->SetParentPageId(new_root_page_id);
@@ -288,6 +586,106 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
   }
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Bulk load an empty tree from the pairs of the sorter. The number of nodes on every level is planned up front from
+ * the number of pairs, so that the sorted pairs can be streamed into the leaves, each new node being added to its
+ * parent as it is started. Only one node per level is pinned at a time.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(ExternalSorter<KeyType, ValueType, KeyComparator> *sorter, double fill_factor) {
+  if (!IsEmpty()) {
+    return false;
+  }
+  sorter->Sort();
+  if (sorter->GetSize() == 0) {
+    return true;
+  }
+
+  std::vector<BulkLoadLevel> levels;
+  int num_items = static_cast<int>(sorter->GetSize());
+  do {
+    bool is_leaf = levels.empty();
+    int max_size = is_leaf ? leaf_max_size_ : internal_max_size_;
+    if (slotted_) {
+      // the keys aren't known yet, so a slotted node gets as many items as fit with keys of any length
+      max_size = std::min(max_size, is_leaf ? LeafPage::SlottedCapacity() : InternalPage::SlottedCapacity());
+    }
+    // a node splits once it reaches its max size, and an internal node needs two children to be of any use
+    int capacity = max_size - 1;
+    int min_size = std::max(max_size / 2, is_leaf ? 1 : 2);
+    int target = std::max(min_size, std::min(static_cast<int>(std::lround(fill_factor * capacity)), capacity));
+    int num_nodes = (num_items + target - 1) / target;
+    // the last node would be underfull, spread its items over the other nodes while they can take them
+    while (num_nodes > 1 && num_items / num_nodes < min_size &&
+           (num_items + num_nodes - 2) / (num_nodes - 1) <= capacity) {
+      num_nodes--;
+    }
+    levels.push_back({num_items, num_nodes, 0, 0, nullptr});
+    num_items = num_nodes;
+  } while (num_items > 1);
+
+  KeyType key;
+  ValueType value;
+  while (sorter->Next(&key, &value)) {
+    Page *page = BulkLoadNode(&levels, 0, key);
+    reinterpret_cast<LeafPage *>(page->GetData())->Append(key, value);
+    levels[0].items_left--;
+  }
+
+  root_page_id_ = levels.back().page->GetPageId();
+  rightmost_leaf_.store(levels.front().page->GetPageId());
+  for (auto &level : levels) {
+    buffer_pool_manager_->UnpinPage(level.page->GetPageId(), true);
+  }
+  UpdateRootPageId(true);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::BulkLoadNode(std::vector<BulkLoadLevel> *levels, size_t height, const KeyType &key) {
+  BulkLoadLevel &level = (*levels)[height];
+  if (level.page != nullptr && level.items_left > 0) {
+    return level.page;
+  }
+
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPageInSegment(&page_id, &segment_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::BulkLoadNode out of memory");
+  }
+  page_id_t parent_page_id = INVALID_PAGE_ID;
+  if (height + 1 < levels->size()) {
+    Page *parent = BulkLoadNode(levels, height + 1, key);
+    reinterpret_cast<InternalPage *>(parent->GetData())->Append(key, page_id);
+    (*levels)[height + 1].items_left--;
+    parent_page_id = parent->GetPageId();
+  }
+  if (height == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, parent_page_id, leaf_max_size_, slotted_);
+    if (level.page != nullptr) {
+      reinterpret_cast<LeafPage *>(level.page->GetData())->SetNextPageId(page_id);
+      reinterpret_cast<LeafPage *>(level.page->GetData())->SetHighKey(key);
+    }
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, parent_page_id, internal_max_size_, slotted_);
+    if (level.page != nullptr) {
+      reinterpret_cast<InternalPage *>(level.page->GetData())->SetNextPageId(page_id);
+      reinterpret_cast<InternalPage *>(level.page->GetData())->SetHighKey(key);
+    }
+  }
+  if (level.page != nullptr) {
+    buffer_pool_manager_->UnpinPage(level.page->GetPageId(), true);
+  }
+
+  level.page = page;
+  level.items_left = level.num_items / level.num_nodes + (level.node_index < level.num_items % level.num_nodes ? 1 : 0);
+  level.node_index++;
+  return page;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -303,6 +701,10 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   if (IsEmpty()) {
     return;
   }
+  if (b_link_) {
+    BLinkRemove(key);
+    return;
+  }
 
   Page *page = InternalFindLeafPage(&key, false, LatchMode::UPDATE);
   LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
@@ -317,7 +719,7 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
       // try to delete if page will not underflow
       ret = leaf_page->RemoveAndDeleteRecord(key, comparator_) < current_size;
     } else if (int idx = leaf_page->KeyIndex(key, this->comparator_);
-               this->comparator_(key, leaf_page->KeyAt(idx)) != 0) {
+               idx == current_size || this->comparator_(key, leaf_page->KeyAt(idx)) != 0) {
       // key does not exist
       ret = 0;
     }
@@ -354,6 +756,20 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   discarded_pages_.clear();
 }
 
+/*
+ * Remove the key from its leaf in B-link mode. Nodes are not merged, since a merge would have to latch the parent
+ * together with the children, so the leaf may become empty.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::BLinkRemove(const KeyType &key) {
+  Page *page = BLinkFindLeafPage(&key, false, true, nullptr);
+  auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  int size = leaf_page->GetSize();
+  bool removed = leaf_page->RemoveAndDeleteRecord(key, comparator_) < size;
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), removed);
+}
+
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
@@ -401,7 +817,11 @@ void BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
 
   int index = neighbor_idx < node_idx;
 
-  if (neighbor_tree_page->GetSize() + node->GetSize() <= node->GetMaxSize()) {
+  // a node splits as soon as it reaches its max size, so a merged node must stay below it; otherwise the next insert
+  // into it would write one entry past the end of the page. A slotted internal node needs room for one more entry,
+  // since the key it gets from the parent may be longer than the first key it replaces.
+  int max_size = node->GetMaxSize() - (slotted_ && !node->IsLeafPage() ? 1 : 0);
+  if (neighbor_tree_page->GetSize() + node->GetSize() < max_size) {
     // merge
     bool underflow = Coalesce(&neighbor_tree_page, &node, &parent_tree_page, index, transaction);
     if (underflow) {
@@ -440,6 +860,9 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
     // NOLINTNEXTLINE
     if constexpr (std::is_same_v<N, LeafPage>) {
       (*neighbor_node)->MoveAllTo(*node);
+      // the leaf that is left is the right-most one if the merged one was
+      page_id_t rightmost_leaf = (*neighbor_node)->GetPageId();
+      rightmost_leaf_.compare_exchange_strong(rightmost_leaf, (*node)->GetPageId());
     } else {  // NOLINT
       (*neighbor_node)->MoveAllTo(*node, (*parent)->KeyAt(idx), buffer_pool_manager_);
     }
@@ -450,6 +873,8 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
     // NOLINTNEXTLINE
     if constexpr (std::is_same_v<N, LeafPage>) {
       (*node)->MoveAllTo(*neighbor_node);
+      page_id_t rightmost_leaf = (*node)->GetPageId();
+      rightmost_leaf_.compare_exchange_strong(rightmost_leaf, (*neighbor_node)->GetPageId());
     } else {  // NOLINT
       (*node)->MoveAllTo(*neighbor_node, (*parent)->KeyAt(idx + 1), buffer_pool_manager_);
     }
@@ -500,6 +925,15 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {
     }
     parent_tree_page->SetKeyAt(idx + 1, middle_key);
   }
+
+  if (slotted_ && parent_tree_page->GetSize() >= parent_tree_page->GetMaxSize()) {
+    // the new key of a slotted parent may be longer than the old one, so that there is no room for another child
+    InternalPage *sibling_tree_page = Split(parent_tree_page);
+    InsertIntoParent(parent_tree_page, sibling_tree_page->KeyAt(0), sibling_tree_page);
+    Page *sibling_page = reinterpret_cast<Page *>(sibling_tree_page);
+    sibling_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+  }
 }
 /*
  * Update root page if necessary
@@ -536,6 +970,9 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::begin() {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
   Page *page = FindLeafPage(key, false);
+  if (page == nullptr) {
+    return end();
+  }
   LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
   auto index = leaf_page->KeyIndex(key, comparator_);
   return INDEXITERATOR_TYPE(page, index, buffer_pool_manager_);
@@ -549,6 +986,29 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::end() { return INDEXITERATOR_TYPE(nullptr, -1, nullptr); }
 
+/*
+ * Input parameter is void, find the right most leaf page first, then construct a descending index iterator
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  int index = -1;
+  Page *page = FindLeafPageBefore(nullptr, true, &index);
+  return INDEXITERATOR_TYPE(page, index, buffer_pool_manager_, this);
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the last key not greater than the input key first,
+ * then construct a descending index iterator
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  int index = -1;
+  Page *page = FindLeafPageBefore(&key, true, &index);
+  return INDEXITERATOR_TYPE(page, index, buffer_pool_manager_, this);
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
@@ -567,10 +1027,42 @@ Page *BPLUSTREE_TYPE::InternalFindLeafPage(const KeyType *key, bool left_most, L
     return nullptr;
   }
 
-  auto next_page_id = root_page_id_.load();
-
   latch_registry_.clear();
 
+  if (b_link_) {
+    // writers of a B-link tree have their own descent, so this is a reader
+    Page *leaf = BLinkFindLeafPage(key, left_most, false, nullptr);
+    if (leaf != nullptr) {
+      latch_registry_[leaf->GetPageId()] = LatchRecord{leaf, false};
+    }
+    return leaf;
+  }
+
+  if (latch_mode == LatchMode::READ || latch_mode == LatchMode::UPDATE) {
+    // only the leaf is latched in these modes, so the inner pages can be passed optimistically
+    for (int attempt = 0; attempt < OPTIMISTIC_ATTEMPTS; attempt++) {
+      Page *leaf;
+      uint64_t version;
+      if (!OptimisticFindLeafPage(key, left_most, true, &leaf, &version)) {
+        continue;
+      }
+      if (leaf == nullptr) {
+        return nullptr;
+      }
+      LatchRecord latch_record{leaf, latch_mode == LatchMode::UPDATE};
+      latch_record.Latch();
+      // the leaf still covers the key if no other writer got to it since its version was read
+      if (leaf->GetVersion() == version + (latch_record.is_write ? 1 : 0)) {
+        latch_registry_[leaf->GetPageId()] = latch_record;
+        return leaf;
+      }
+      latch_record.Unlatch();
+      buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+    }
+  }
+
+  auto next_page_id = root_page_id_.load();
+
   bool first_round = true;
 
   while (true) {
@@ -606,13 +1098,18 @@ Page *BPLUSTREE_TYPE::InternalFindLeafPage(const KeyType *key, bool left_most, L
       release_parents = tree_page->GetSize() < tree_page->GetMaxSize() - 1;
     } else if (latch_mode == LatchMode::DELETE) {
       release_parents = tree_page->GetSize() > tree_page->GetMinSize();
+      if (slotted_ && !tree_page->IsLeafPage()) {
+        // a redistribution below may give the page a longer key, then it has to split if it is out of room
+        release_parents = release_parents && tree_page->GetSize() < tree_page->GetMaxSize() - 1;
+      }
     }
     if (release_parents) {
       while (!latch_registry_.empty()) {
-        LatchRecord parent_latch_record = latch_registry_.begin()->second;
-        parent_latch_record.Unlatch();
-        buffer_pool_manager_->UnpinPage(parent_latch_record.page->GetPageId(), false);
-        latch_registry_.erase(parent_latch_record.page->GetPageId());
+        // the page may be evicted as soon as it is unpinned, so do not read its id afterwards
+        auto parent_iter = latch_registry_.begin();
+        parent_iter->second.Unlatch();
+        buffer_pool_manager_->UnpinPage(parent_iter->first, false);
+        latch_registry_.erase(parent_iter);
       }
     }
 
@@ -631,6 +1128,305 @@ Page *BPLUSTREE_TYPE::InternalFindLeafPage(const KeyType *key, bool left_most, L
   }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::OptimisticFindLeafPage(const KeyType *key, bool left_most, bool pin_leaf, Page **leaf,
+                                            uint64_t *leaf_version) {
+  *leaf = nullptr;
+  auto page_id = root_page_id_.load();
+  if (page_id == INVALID_PAGE_ID) {
+    return true;
+  }
+
+  uint64_t version;
+  Page *page = OptimisticFetchPage(page_id, &version);
+  if (page == nullptr) {
+    return false;
+  }
+  // the root may have been replaced before we got here
+  if (page_id != root_page_id_.load()) {
+    buffer_pool_manager_->UnpinPageOptimistic(page);
+    return false;
+  }
+
+  while (true) {
+    BPlusTreePage *tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool is_leaf = tree_page->IsLeafPage();
+    // every read from the page may have seen a writer's half done changes, it is checked before it is relied on
+    if (!page->ValidateVersion(version)) {
+      break;
+    }
+    if (is_leaf) {
+      if (pin_leaf) {
+        // an unchanged version after pinning means that the frame still holds the leaf and nobody wrote it meanwhile
+        buffer_pool_manager_->UnpinPageOptimistic(page);
+        Page *pinned_page = buffer_pool_manager_->FetchPage(page_id);
+        if (pinned_page == nullptr) {
+          throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::OptimisticFindLeafPage out of memory");
+        }
+        if (pinned_page != page || !page->ValidateVersion(version)) {
+          buffer_pool_manager_->UnpinPage(page_id, false);
+          return false;
+        }
+      }
+      *leaf = page;
+      *leaf_version = version;
+      return true;
+    }
+
+    InternalPage *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+    auto child_page_id = left_most ? internal_page->ValueAt(0) : internal_page->Lookup(*key, comparator_);
+    if (!page->ValidateVersion(version)) {
+      break;
+    }
+    // the optimistic pin must not be held while the child is fetched, the version of the page still tells whether
+    // the page has changed or left its frame since
+    buffer_pool_manager_->UnpinPageOptimistic(page);
+    uint64_t child_version;
+    Page *child_page = OptimisticFetchPage(child_page_id, &child_version);
+    if (child_page == nullptr) {
+      return false;
+    }
+    // the child may have been split, merged or even deleted since its id was read, unless the parent is unchanged
+    if (!page->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPageOptimistic(child_page);
+      return false;
+    }
+    page = child_page;
+    page_id = child_page_id;
+    version = child_version;
+  }
+
+  buffer_pool_manager_->UnpinPageOptimistic(page);
+  return false;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::OptimisticFetchPage(page_id_t page_id, uint64_t *version) {
+  Page *page = buffer_pool_manager_->FetchPageOptimistic(page_id, version);
+  if (page != nullptr) {
+    return page;
+  }
+  // the page is not in the buffer pool, or it could not be found there without the latch: fetching it brings it in
+  // and points the buffer pool's lookup at it
+  if (buffer_pool_manager_->FetchPage(page_id) == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::OptimisticFetchPage out of memory");
+  }
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return buffer_pool_manager_->FetchPageOptimistic(page_id, version);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::BLinkFindLeafPage(const KeyType *key, bool left_most, bool exclusive,
+                                       std::vector<page_id_t> *path) {
+  auto page_id = root_page_id_.load();
+  if (page_id == INVALID_PAGE_ID) {
+    return nullptr;
+  }
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::BLinkFindLeafPage out of memory");
+  }
+  // the pages of a B-link tree are never freed and never change their type, so the latch a page needs is known before
+  // it is latched; a root that has been replaced meanwhile still leads to the key by moving right
+  bool is_leaf = reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage();
+  bool write_latched = exclusive && is_leaf;
+  write_latched ? page->WLatch() : page->RLatch();
+
+  while (true) {
+    if (!left_most) {
+      page = MoveRight(page, key, write_latched);
+    }
+    if (is_leaf) {
+      return page;
+    }
+
+    auto *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+    if (path != nullptr) {
+      path->push_back(page->GetPageId());
+    }
+    page_id_t child_page_id = left_most ? internal_page->ValueAt(0) : internal_page->Lookup(*key, comparator_);
+    Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+    if (child_page == nullptr) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::BLinkFindLeafPage out of memory");
+    }
+    is_leaf = reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage();
+    write_latched = exclusive && is_leaf;
+    write_latched ? child_page->WLatch() : child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::MoveRight(Page *page, const KeyType *key, bool exclusive, bool before, KeyType *low_key) {
+  if (!b_link_) {
+    return page;
+  }
+  while (true) {
+    auto *tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    page_id_t next_page_id;
+    const KeyType *high_key;
+    if (tree_page->IsLeafPage()) {
+      next_page_id = reinterpret_cast<LeafPage *>(tree_page)->GetNextPageId();
+      high_key = &reinterpret_cast<LeafPage *>(tree_page)->GetHighKey();
+    } else {
+      next_page_id = reinterpret_cast<InternalPage *>(tree_page)->GetNextPageId();
+      high_key = &reinterpret_cast<InternalPage *>(tree_page)->GetHighKey();
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      return page;
+    }
+    if (key != nullptr) {
+      int cmp = comparator_(*key, *high_key);
+      if (cmp < 0 || (before && cmp == 0)) {
+        return page;
+      }
+    }
+
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      exclusive ? page->WUnlatch() : page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::MoveRight out of memory");
+    }
+    exclusive ? next_page->WLatch() : next_page->RLatch();
+    if (low_key != nullptr) {
+      *low_key = *high_key;
+    }
+    exclusive ? page->WUnlatch() : page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = next_page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafParentPage(const KeyType &key, KeyType *upper, bool *bounded) {
+  while (true) {
+    auto page_id = root_page_id_.load();
+    if (page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::FindLeafParentPage out of memory");
+    }
+    page->RLatch();
+    if (page_id != root_page_id_.load()) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      continue;
+    }
+
+    *bounded = false;
+    page = MoveRight(page, &key, false);
+    while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      auto *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+      if (b_link_) {
+        // the page's own high key, the separators above may not know about all splits yet
+        *bounded = internal_page->GetNextPageId() != INVALID_PAGE_ID;
+        *upper = internal_page->GetHighKey();
+      }
+      int child_index = internal_page->LookupIndex(key, comparator_);
+      page_id_t child_page_id = internal_page->ValueAt(child_index);
+      Page *child_page = buffer_pool_manager_->FetchPage(child_page_id);
+      if (child_page == nullptr) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::FindLeafParentPage out of memory");
+      }
+      // the type of a page doesn't change while its parent is latched, so the child is checked without a latch
+      if (reinterpret_cast<BPlusTreePage *>(child_page->GetData())->IsLeafPage()) {
+        buffer_pool_manager_->UnpinPage(child_page_id, false);
+        return page;
+      }
+      child_page->RLatch();
+      if (child_index + 1 < internal_page->GetSize()) {
+        *upper = internal_page->KeyAt(child_index + 1);
+        *bounded = true;
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = MoveRight(child_page, &key, false);
+    }
+    // the root is a leaf
+    return page;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageBefore(const KeyType *key, bool inclusive, int *index) {
+  KeyType search_key;
+  KeyType fence;
+  while (true) {
+    auto page_id = root_page_id_.load();
+    if (page_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::FindLeafPageBefore out of memory");
+    }
+    page->RLatch();
+    if (page_id != root_page_id_.load()) {
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      continue;
+    }
+
+    // the separator key of the lowest level at which the descent did not take the first child, or the high key of the
+    // last page it moved right from
+    bool has_fence = false;
+    auto move_right = [&](Page *current) {
+      Page *next = MoveRight(current, key, false, !inclusive, &fence);
+      has_fence = has_fence || next != current;
+      return next;
+    };
+    page = move_right(page);
+    while (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsLeafPage()) {
+      auto *internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+      int child_index =
+          key == nullptr ? internal_page->GetSize() - 1 : internal_page->LookupIndex(*key, comparator_, !inclusive);
+      if (child_index > 0) {
+        fence = internal_page->KeyAt(child_index);
+        has_fence = true;
+      }
+      Page *child_page = buffer_pool_manager_->FetchPage(internal_page->ValueAt(child_index));
+      if (child_page == nullptr) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "BPLUSTREE_TYPE::FindLeafPageBefore out of memory");
+      }
+      child_page->RLatch();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = move_right(child_page);
+    }
+
+    auto *leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    if (key == nullptr) {
+      *index = leaf_page->GetSize() - 1;
+    } else {
+      *index = (inclusive ? leaf_page->UpperKeyIndex(*key, comparator_) : leaf_page->KeyIndex(*key, comparator_)) - 1;
+    }
+    if (*index >= 0) {
+      return page;
+    }
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!has_fence) {
+      return nullptr;
+    }
+    // the leaf is the first one under the fence and has no key before the searched one (the separator keys are not
+    // removed with their keys), so the key before is the last one before the fence
+    search_key = fence;
+    key = &search_key;
+    inclusive = false;
+  }
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -654,12 +1450,22 @@ void BPLUSTREE_TYPE::UpdateRootPageId(bool insert_record) {
 
 /*
  * This method is used for test only
- * Read data from file and insert one by one
+ * Read data from file and insert one by one, or bulk load it into an empty tree
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *transaction) {
   int64_t key;
   std::ifstream input(file_name);
+  if (IsEmpty()) {
+    ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+    while (input >> key) {
+      KeyType index_key;
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(key));
+    }
+    BulkLoad(&sorter);
+    return;
+  }
   while (input) {
     input >> key;
 
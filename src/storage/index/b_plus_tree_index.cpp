@@ -9,23 +9,58 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <limits>
+
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
+
+namespace {
+/** Whether the key has a varchar column, which mostly leaves a large part of the key empty. */
+bool HasVarcharColumn(const Schema *key_schema) {
+  const auto &columns = key_schema->GetColumns();
+  return std::any_of(columns.begin(), columns.end(),
+                     [](const Column &column) { return column.GetType() == TypeId::VARCHAR; });
+}
+}  // namespace
+
 /*
- * Constructor
+ * Constructor. The keys of an index on varchar columns are stored in slotted pages, which only take as many bytes of
+ * a key as it needs.
  */
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(IndexMetadata *metadata, BufferPoolManager *buffer_pool_manager)
     : Index(metadata),
       comparator_(metadata->GetKeySchema()),
-      container_(metadata->GetName(), buffer_pool_manager, comparator_) {}
+      container_(metadata->GetName(), buffer_pool_manager, comparator_,
+                 HasVarcharColumn(metadata->GetKeySchema()) ? SLOTTED_LEAF_PAGE_SIZE : LEAF_PAGE_SIZE,
+                 HasVarcharColumn(metadata->GetKeySchema()) ? SLOTTED_INTERNAL_PAGE_SIZE : INTERNAL_PAGE_SIZE, false,
+                 HasVarcharColumn(metadata->GetKeySchema())) {
+  if (!metadata->IsUnique() && sizeof(KeyType) <= KeyType::RID_SUFFIX_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the key of a non-unique index must be larger than a RID");
+  }
+  // a key lookup takes every tree key with the same key columns for a match, so they must not be cut off
+  if (!metadata->IsUnique() &&
+      KeyType::MaxEncodedSize(metadata->GetKeySchema()) > sizeof(KeyType) - KeyType::RID_SUFFIX_SIZE) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "the key columns of a non-unique index don't fit in the key");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::SetIndexKey(KeyType *index_key, const Tuple &key, RID rid) {
+  if (IsUnique()) {
+    index_key->SetFromKey(key, GetKeySchema());
+  } else {
+    index_key->SetFromKey(key, GetKeySchema(), rid);
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(&index_key, key, rid);
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,7 +69,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  SetIndexKey(&index_key, key, rid);
 
   container_.Remove(index_key, transaction);
 }
@@ -43,9 +78,45 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  if (IsUnique()) {
+    index_key.SetFromKey(key, GetKeySchema());
+    container_.GetValue(index_key, result, transaction);
+    return;
+  }
+
+  // the smallest RID suffix, so that the scan starts before the first row with the key
+  index_key.SetFromKey(key, GetKeySchema(), RID(std::numeric_limits<page_id_t>::min(), 0));
+  for (auto iter = container_.Begin(index_key); !iter.isEnd() && (*iter).first.HasSameColumns(index_key); ++iter) {
+    result->push_back((*iter).second);
+  }
+}
 
-  container_.GetValue(index_key, result, transaction);
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanKeys(const std::vector<Tuple> &keys, std::vector<std::vector<RID>> *result,
+                                    Transaction *transaction) {
+  // the keys of a non-unique index are ranges of tree keys, which are scanned one by one
+  if (!IsUnique()) {
+    Index::ScanKeys(keys, result, transaction);
+    return;
+  }
+  std::vector<KeyType> index_keys(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    index_keys[i].SetFromKey(keys[i], GetKeySchema());
+  }
+  container_.GetValues(index_keys, result, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(Tuple *key, RID *rid)> &next_entry, double fill_factor) {
+  ExternalSorter<KeyType, ValueType, KeyComparator> sorter(comparator_);
+  Tuple key;
+  RID rid;
+  while (next_entry(&key, &rid)) {
+    KeyType index_key;
+    SetIndexKey(&index_key, key, rid);
+    sorter.Add(index_key, rid);
+  }
+  return container_.BulkLoad(&sorter, fill_factor);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -57,6 +128,12 @@ INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator(const KeyType &key) {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetEndIterator() { return container_.end(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator() { return container_.RBegin(); }
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetReverseBeginIterator(const KeyType &key) { return container_.RBegin(key); }
+
 template class BPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
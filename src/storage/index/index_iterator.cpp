@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -14,6 +15,23 @@ namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE::IndexIterator(Page *page, int key_index, BufferPoolManager *buffer_pool_manager)
     : page_(page), key_index_(key_index), buffer_pool_manager_(buffer_pool_manager), is_end_(false) {
+  if (page_ == nullptr || key_index_ < 0 || buffer_pool_manager_ == nullptr) {
+    SetAsEnd();
+    return;
+  }
+  // a seek past the last key of the leaf starts at the first key of the next leaf
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page_->GetData());
+  if (key_index_ >= leaf_page->GetSize()) {
+    key_index_ = leaf_page->GetSize() - 1;
+    operator++();
+    return;
+  }
+  PrefetchNextLeaf();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(Page *page, int key_index, BufferPoolManager *buffer_pool_manager, Tree *tree)
+    : page_(page), key_index_(key_index), buffer_pool_manager_(buffer_pool_manager), is_end_(false), tree_(tree) {
   if (page_ == nullptr || key_index_ < 0 || buffer_pool_manager_ == nullptr) {
     SetAsEnd();
   }
@@ -42,9 +60,20 @@ void INDEXITERATOR_TYPE::SetAsEnd() {
   buffer_pool_manager_ = nullptr;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::PrefetchNextLeaf() {
+  LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page_->GetData());
+  buffer_pool_manager_->PrefetchPage(leaf_page->GetNextPageId());
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 const MappingType &INDEXITERATOR_TYPE::operator*() {
   LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page_->GetData());
+  if (leaf_page->IsSlotted()) {
+    // the pairs of a slotted leaf are put together when they are read
+    item_ = {leaf_page->KeyAt(key_index_), leaf_page->ValueAt(key_index_)};
+    return item_;
+  }
   return leaf_page->GetItem(key_index_);
 }
 
@@ -55,9 +84,29 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
   }
   LeafPage *leaf_page = reinterpret_cast<LeafPage *>(page_->GetData());
 
+  if (tree_ != nullptr) {
+    if (key_index_ > 0) {
+      key_index_--;
+      return *this;
+    }
+    // the leaf before can't be latched while this one is held, scans and splits latch leaves from left to right
+    KeyType first_key = leaf_page->KeyAt(0);
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
+    page_ = tree_->FindLeafPageBefore(&first_key, false, &key_index_);
+    if (page_ == nullptr) {
+      SetAsEnd();
+    }
+    return *this;
+  }
+
   if (key_index_ < leaf_page->GetSize() - 1) {
     key_index_++;
-  } else {
+    return *this;
+  }
+
+  // a B-link tree doesn't merge leaves, so there may be empty ones to skip
+  do {
     auto next_page_id = leaf_page->GetNextPageId();
 
     if (next_page_id == INVALID_PAGE_ID) {
@@ -73,10 +122,11 @@ INDEXITERATOR_TYPE &INDEXITERATOR_TYPE::operator++() {
     page_->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_->GetPageId(), false);
     page_ = page;
+    leaf_page = reinterpret_cast<LeafPage *>(page_->GetData());
+  } while (leaf_page->GetSize() == 0);
+  PrefetchNextLeaf();
 
-    key_index_ = 0;
-  }
-
+  key_index_ = 0;
   return *this;
 }
 
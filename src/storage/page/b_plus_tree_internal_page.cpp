@@ -9,10 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -22,25 +25,85 @@ namespace bustub {
 /*
  * Init method after creating a new internal page
  * Including set page type, set current size, set page id, set parent id and set
- * max page size
+ * max page size. A slotted page may have at most max_size children, fewer if their keys don't fit.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool slotted) {
   SetPageId(page_id);
   SetParentPageId(parent_id);
-  SetMaxSize(max_size);
   SetSize(0);
   SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetNextPageId(INVALID_PAGE_ID);
+  if (slotted) {
+    max_entries_ = static_cast<uint16_t>(std::min<int>(max_size, SLOTTED_INTERNAL_PAGE_SIZE));
+    Slotted().Clear();
+    UpdateSlottedMaxSize();
+  } else {
+    max_entries_ = 0;
+    key_begin_ = 0;
+    SetMaxSize(max_size);
+  }
 }
+
+/*
+ * Helper methods for the slotted format
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::IsSlotted() const { return max_entries_ != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::SlottedCapacity() {
+  return SlottedKeys<KeyType, ValueType>::Capacity(PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+SlottedKeys<KeyType, ValueType> B_PLUS_TREE_INTERNAL_PAGE_TYPE::Slotted() const {
+  auto *page = const_cast<BPlusTreeInternalPage *>(this);
+  return SlottedKeys<KeyType, ValueType>(reinterpret_cast<char *>(page->array), PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE,
+                                         &page->key_begin_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::UpdateSlottedMaxSize() {
+  int room = static_cast<int>(Slotted().FreeSpace(GetSize()) / SlottedKeys<KeyType, ValueType>::MAX_ENTRY_SIZE);
+  SetMaxSize(std::min<int>(max_entries_, GetSize() + room));
+}
+
+/*
+ * Helper methods to set/get the right sibling and the high key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType &B_PLUS_TREE_INTERNAL_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const { return array[index].first; }
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
+  return IsSlotted() ? Slotted().KeyAt(index) : array[index].first;
+}
 
+/*
+ * A slotted page must have room for the new key; it may be full afterwards (see BPlusTree::Redistribute)
+ */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {
+  if (IsSlotted()) {
+    Slotted().SetKeyAt(GetSize(), index, key);
+    UpdateSlottedMaxSize();
+    return;
+  }
+  array[index].first = key;
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
@@ -49,7 +112,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { a
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
   for (int i = 0; i < GetSize(); i++) {
-    if (array[i].second == value) {
+    if (ValueAt(i) == value) {
       return i;
     }
   }
@@ -61,7 +124,9 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return array[index].second; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const {
+  return IsSlotted() ? Slotted().ValueAt(index) : array[index].second;
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -73,20 +138,29 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return arra
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  if (comparator(key, KeyAt(1)) < 0) {
-    return ValueAt(0);
-  }
-  int l = 1;
-  int r = GetSize() - 1;
-  while (l < r) {
-    int mid = (l + r + 1) >> 1;
-    if (comparator(key, KeyAt(mid)) < 0) {
-      r = mid - 1;
-    } else {
-      l = mid;
+  return ValueAt(LookupIndex(key, comparator));
+}
+
+/*
+ * Find and return the index of the child that contains input "key". If "before" is set, return the index of the child
+ * that contains the keys right before input "key" instead, i.e. the child whose separator key is the last one that is
+ * less than "key".
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator,
+                                                bool before) const {
+  // the number of keys not greater than (before: less than) key is the index of the child, the first key is not
+  // searched
+  if (IsSlotted()) {
+    if (before) {
+      return Slotted().LowerBound(1, GetSize(), key, comparator) - 1;
     }
+    return Slotted().UpperBound(1, GetSize(), key, comparator) - 1;
+  }
+  if (before) {
+    return KeySearch<KeyType, KeyComparator>::LowerBound(array + 1, GetSize() - 1, key, comparator);
   }
-  return ValueAt(l);
+  return KeySearch<KeyType, KeyComparator>::UpperBound(array + 1, GetSize() - 1, key, comparator);
 }
 
 /*****************************************************************************
@@ -101,6 +175,18 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
                                                      const ValueType &new_value) {
+  if (IsSlotted()) {
+    // the first key is not used, it is stored empty
+    KeyType first_key;
+    std::memset(reinterpret_cast<char *>(&first_key), 0, sizeof(KeyType));
+    auto slotted = Slotted();
+    slotted.Clear();
+    slotted.Insert(0, 0, first_key, old_value);
+    slotted.Insert(1, 1, new_key, new_value);
+    SetSize(2);
+    UpdateSlottedMaxSize();
+    return;
+  }
   array[0].second = old_value;
   array[1] = {new_key, new_value};
   SetSize(2);
@@ -115,6 +201,12 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
                                                     const ValueType &new_value) {
   for (int i = 0; i < GetSize(); i++) {
     if (ValueAt(i) == old_value) {
+      if (IsSlotted()) {
+        Slotted().Insert(GetSize(), i + 1, new_key, new_value);
+        IncreaseSize(1);
+        UpdateSlottedMaxSize();
+        return GetSize();
+      }
       for (int j = GetSize() - 1; j >= i + 1; j--) {
         array[j + 1] = array[j];
       }
@@ -126,18 +218,83 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
   return GetSize();
 }
 
+/*
+ * Insert new_key & new_value pair at the position of new_key in key order, after the pairs with keys not greater than
+ * new_key. Used by a B-link tree, whose parent may not know the left sibling of the new child yet.
+ * @return:  new size after insertion
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNode(const KeyType &new_key, const ValueType &new_value,
+                                               const KeyComparator &comparator) {
+  int index = LookupIndex(new_key, comparator) + 1;
+  if (IsSlotted()) {
+    Slotted().Insert(GetSize(), index, new_key, new_value);
+    IncreaseSize(1);
+    UpdateSlottedMaxSize();
+    return GetSize();
+  }
+  for (int i = GetSize() - 1; i >= index; i--) {
+    array[i + 1] = array[i];
+  }
+  array[index] = {new_key, new_value};
+  IncreaseSize(1);
+  return GetSize();
+}
+
+/*
+ * Append new_key & new_value pair at the end of the page. The key of the first child is ignored, as always. The
+ * child's parent page id is not changed: a bulk load creates the child with the right parent id in the first place.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  if (IsSlotted()) {
+    Slotted().Insert(GetSize(), GetSize(), key, value);
+    IncreaseSize(1);
+    UpdateSlottedMaxSize();
+    return;
+  }
+  array[GetSize()] = {key, value};
+  IncreaseSize(1);
+}
+
 /*****************************************************************************
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page. A slotted page that is out of room for keys
+ * before it is full keeps half of the bytes of its pairs instead.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
                                                 BufferPoolManager *buffer_pool_manager) {
-  int n = GetSize() / 2;
-  recipient->CopyNFrom(&array[n], GetSize() - n, buffer_pool_manager);
-  SetSize(n);
+  if (IsSlotted() && GetSize() < max_entries_) {
+    MoveTailTo(recipient, Slotted().SplitIndex(GetSize()), buffer_pool_manager);
+    return;
+  }
+  MoveTailTo(recipient, GetSize() / 2, buffer_pool_manager);
+}
+
+/*
+ * Remove the key & value pairs from input "index" on from this page to "recipient" page, to split a page unevenly
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveTailTo(BPlusTreeInternalPage *recipient, int index,
+                                                BufferPoolManager *buffer_pool_manager) {
+  if (IsSlotted()) {
+    auto slotted = Slotted();
+    for (int i = index; i < GetSize(); i++) {
+      recipient->Append(slotted.KeyAt(i), slotted.ValueAt(i));
+      if (buffer_pool_manager != nullptr) {
+        recipient->Adopt(slotted.ValueAt(i), buffer_pool_manager);
+      }
+    }
+    slotted.Truncate(index);
+    SetSize(index);
+    UpdateSlottedMaxSize();
+    return;
+  }
+  recipient->CopyNFrom(&array[index], GetSize() - index, buffer_pool_manager);
+  SetSize(index);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -154,14 +311,17 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(page_id_t page_id, BufferPoolManager
 
 /* Copy entries into me, starting from {items} and copy {size} entries.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
- * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
+ * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger.
+ * A B-link tree passes no buffer pool manager: it doesn't keep parent page ids, so the children are left alone.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {
   std::copy(items, items + size, &array[0]);
-  for (int i = 0; i < size; i++) {
-    auto page_id = items[i].second;
-    Adopt(page_id, buffer_pool_manager);
+  if (buffer_pool_manager != nullptr) {
+    for (int i = 0; i < size; i++) {
+      auto page_id = items[i].second;
+      Adopt(page_id, buffer_pool_manager);
+    }
   }
   SetSize(size);
 }
@@ -176,6 +336,12 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  if (IsSlotted()) {
+    Slotted().Remove(GetSize(), index);
+    IncreaseSize(-1);
+    UpdateSlottedMaxSize();
+    return;
+  }
   for (int i = index + 1; i < GetSize(); i++) {
     array[i - 1] = array[i];
   }
@@ -190,6 +356,12 @@ INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
   auto page_id = ValueAt(0);
   BUSTUB_ASSERT(GetSize() == 1, "GetSize() != 1");
+  if (IsSlotted()) {
+    Slotted().Clear();
+    SetSize(0);
+    UpdateSlottedMaxSize();
+    return page_id;
+  }
   SetSize(0);
   return page_id;
 }
@@ -206,12 +378,24 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                BufferPoolManager *buffer_pool_manager) {
+  if (IsSlotted()) {
+    for (int i = 0; i < GetSize(); i++) {
+      recipient->Append(i == 0 ? middle_key : KeyAt(i), ValueAt(i));
+      recipient->Adopt(ValueAt(i), buffer_pool_manager);
+    }
+    recipient->SetNextPageId(GetNextPageId());
+    Slotted().Clear();
+    SetSize(0);
+    UpdateSlottedMaxSize();
+    return;
+  }
   array[0].first = middle_key;
   std::copy(array, array + GetSize(), recipient->array + recipient->GetSize());
   for (int i = recipient->GetSize(); i < recipient->GetSize() + GetSize(); i++) {
     recipient->Adopt(recipient->array[i].second, buffer_pool_manager);
   }
   recipient->IncreaseSize(GetSize());
+  recipient->SetNextPageId(GetNextPageId());
   SetSize(0);
 }
 
@@ -229,6 +413,12 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                       BufferPoolManager *buffer_pool_manager) {
+  if (IsSlotted()) {
+    recipient->Append(middle_key, ValueAt(0));
+    recipient->Adopt(ValueAt(0), buffer_pool_manager);
+    Remove(0);
+    return;
+  }
   MappingType pair{middle_key, array[0].second};
   recipient->CopyLastFrom(pair, buffer_pool_manager);
   for (int i = 1; i <= GetSize() - 1; i++) {
@@ -258,6 +448,14 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
                                                        BufferPoolManager *buffer_pool_manager) {
+  if (IsSlotted()) {
+    recipient->Slotted().Insert(recipient->GetSize(), 0, KeyAt(GetSize() - 1), ValueAt(GetSize() - 1));
+    recipient->IncreaseSize(1);
+    recipient->UpdateSlottedMaxSize();
+    recipient->Adopt(ValueAt(GetSize() - 1), buffer_pool_manager);
+    Remove(GetSize() - 1);
+    return;
+  }
   recipient->CopyFirstFrom(array[GetSize() - 1], buffer_pool_manager);
   IncreaseSize(-1);
 }
@@ -9,10 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -24,16 +26,48 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next page id and set max size. A slotted page may have at most max_size pairs, fewer if their keys don't fit.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size, bool slotted) {
   SetPageType(IndexPageType::LEAF_PAGE);
   SetSize(0);
   SetPageId(page_id);
   SetParentPageId(parent_id);
-  SetMaxSize(max_size);
   SetNextPageId(INVALID_PAGE_ID);
+  if (slotted) {
+    max_entries_ = static_cast<uint16_t>(std::min<int>(max_size, SLOTTED_LEAF_PAGE_SIZE));
+    Slotted().Clear();
+    UpdateSlottedMaxSize();
+  } else {
+    max_entries_ = 0;
+    key_begin_ = 0;
+    SetMaxSize(max_size);
+  }
+}
+
+/**
+ * Helper methods for the slotted format
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::IsSlotted() const { return max_entries_ != 0; }
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::SlottedCapacity() {
+  return SlottedKeys<KeyType, ValueType>::Capacity(PAGE_SIZE - LEAF_PAGE_HEADER_SIZE);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+SlottedKeys<KeyType, ValueType> B_PLUS_TREE_LEAF_PAGE_TYPE::Slotted() const {
+  auto *page = const_cast<BPlusTreeLeafPage *>(this);
+  return SlottedKeys<KeyType, ValueType>(reinterpret_cast<char *>(page->array), PAGE_SIZE - LEAF_PAGE_HEADER_SIZE,
+                                         &page->key_begin_);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::UpdateSlottedMaxSize() {
+  int room = static_cast<int>(Slotted().FreeSpace(GetSize()) / SlottedKeys<KeyType, ValueType>::MAX_ENTRY_SIZE);
+  SetMaxSize(std::min<int>(max_entries_, GetSize() + room));
 }
 
 /**
@@ -45,27 +79,37 @@ page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_i
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+/**
+ * Helper methods to set/get the high key, only valid if there is a next page
+ */
+INDEX_TEMPLATE_ARGUMENTS
+const KeyType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetHighKey() const { return high_key_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetHighKey(const KeyType &high_key) { high_key_ = high_key; }
+
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
-  int l = 0;
-  int r = GetSize() - 1;
-  if (GetSize() == 0 || comparator(KeyAt(r), key) < 0) {
-    return GetSize();
+  if (IsSlotted()) {
+    return Slotted().LowerBound(0, GetSize(), key, comparator);
   }
-  while (l < r) {
-    int mid = (l + r) >> 1;
-    auto cmp = comparator(key, KeyAt(mid));
-    if (cmp <= 0) {
-      r = mid;
-    } else {
-      l = mid + 1;
-    }
+  return KeySearch<KeyType, KeyComparator>::LowerBound(array, GetSize(), key, comparator);
+}
+
+/**
+ * Helper method to find the first index i so that array[i].first > key
+ * NOTE: This method is only used when generating a descending index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::UpperKeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  if (IsSlotted()) {
+    return Slotted().UpperBound(0, GetSize(), key, comparator);
   }
-  return l;
+  return KeySearch<KeyType, KeyComparator>::UpperBound(array, GetSize(), key, comparator);
 }
 
 /*
@@ -73,7 +117,18 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return array[index].first; }
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
+  return IsSlotted() ? Slotted().KeyAt(index) : array[index].first;
+}
+
+/*
+ * Helper method to find and return the value associated with input "index"(a.k.a
+ * array offset)
+ */
+INDEX_TEMPLATE_ARGUMENTS
+ValueType B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const {
+  return IsSlotted() ? Slotted().ValueAt(index) : array[index].second;
+}
 
 /*
  * Helper method to find and return the key & value pair associated with input
@@ -95,6 +150,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
   if (idx < GetSize() && comparator(KeyAt(idx), key) == 0) {
     return GetSize();
   }
+  if (IsSlotted()) {
+    Slotted().Insert(GetSize(), idx, key, value);
+    IncreaseSize(1);
+    UpdateSlottedMaxSize();
+    return GetSize();
+  }
   for (int i = GetSize() - 1; i >= idx; i--) {
     array[i + 1] = array[i];
   }
@@ -107,13 +168,38 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  * SPLIT
  *****************************************************************************/
 /*
- * Remove half of key & value pairs from this page to "recipient" page
+ * Remove half of key & value pairs from this page to "recipient" page. A slotted page that is out of room for keys
+ * before it is full keeps half of the bytes of its pairs instead.
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
-  int n = GetSize() / 2;
-  recipient->CopyNFrom(&array[n], GetSize() - n);
-  SetSize(n);
+  if (IsSlotted() && GetSize() < max_entries_) {
+    MoveTailTo(recipient, Slotted().SplitIndex(GetSize()));
+    return;
+  }
+  MoveTailTo(recipient, GetSize() / 2);
+}
+
+/*
+ * Remove the key & value pairs from input "index" on from this page to "recipient" page, to split a page unevenly
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveTailTo(BPlusTreeLeafPage *recipient, int index) {
+  if (IsSlotted()) {
+    auto slotted = Slotted();
+    auto recipient_slotted = recipient->Slotted();
+    for (int i = index; i < GetSize(); i++) {
+      recipient_slotted.Insert(i - index, i - index, slotted.KeyAt(i), slotted.ValueAt(i));
+    }
+    recipient->SetSize(GetSize() - index);
+    recipient->UpdateSlottedMaxSize();
+    slotted.Truncate(index);
+    SetSize(index);
+    UpdateSlottedMaxSize();
+    return;
+  }
+  recipient->CopyNFrom(&array[index], GetSize() - index);
+  SetSize(index);
 }
 
 /*
@@ -142,10 +228,26 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
   if (comparator(KeyAt(idx), key) != 0) {
     return false;
   }
-  *value = array[idx].second;
+  *value = ValueAt(idx);
   return true;
 }
 
+/*
+ * Append key & value pair at the end of the page. The key must be greater than every key already in the page, this
+ * is only used to fill the leaves of a bulk loaded tree in key order.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const KeyType &key, const ValueType &value) {
+  if (IsSlotted()) {
+    Slotted().Insert(GetSize(), GetSize(), key, value);
+    IncreaseSize(1);
+    UpdateSlottedMaxSize();
+    return;
+  }
+  array[GetSize()] = {key, value};
+  IncreaseSize(1);
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -165,6 +267,12 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
     return GetSize();
   }
 
+  if (IsSlotted()) {
+    Slotted().Remove(GetSize(), idx);
+    IncreaseSize(-1);
+    UpdateSlottedMaxSize();
+    return GetSize();
+  }
   for (int i = idx + 1; i < GetSize(); i++) {
     array[i - 1] = array[i];
   }
@@ -182,6 +290,16 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  if (IsSlotted()) {
+    for (int i = 0; i < GetSize(); i++) {
+      recipient->Append(KeyAt(i), ValueAt(i));
+    }
+    recipient->SetNextPageId(GetNextPageId());
+    Slotted().Clear();
+    SetSize(0);
+    UpdateSlottedMaxSize();
+    return;
+  }
   std::copy(array, array + GetSize(), recipient->array + recipient->GetSize());
   recipient->IncreaseSize(GetSize());
   recipient->SetNextPageId(GetNextPageId());
@@ -196,6 +314,13 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  if (IsSlotted()) {
+    recipient->Append(KeyAt(0), ValueAt(0));
+    Slotted().Remove(GetSize(), 0);
+    IncreaseSize(-1);
+    UpdateSlottedMaxSize();
+    return;
+  }
   recipient->CopyLastFrom(array[0]);
   for (int i = 1; i <= GetSize() - 1; i++) {
     array[i - 1] = array[i];
@@ -217,6 +342,15 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  if (IsSlotted()) {
+    recipient->Slotted().Insert(recipient->GetSize(), 0, KeyAt(GetSize() - 1), ValueAt(GetSize() - 1));
+    recipient->IncreaseSize(1);
+    recipient->UpdateSlottedMaxSize();
+    Slotted().Remove(GetSize(), GetSize() - 1);
+    IncreaseSize(-1);
+    UpdateSlottedMaxSize();
+    return;
+  }
   recipient->CopyFirstFrom(array[GetSize() - 1]);
   IncreaseSize(-1);
 }
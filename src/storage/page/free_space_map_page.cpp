@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page.cpp
+//
+// Identification: src/storage/page/free_space_map_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/free_space_map_page.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace bustub {
+
+void FreeSpaceMapPage::Init(page_id_t page_id) {
+  static_assert(sizeof(FreeSpaceMapPage) <= PAGE_SIZE);
+  lsn_ = INVALID_LSN;
+  page_id_ = page_id;
+  next_page_id_ = INVALID_PAGE_ID;
+  size_ = 0;
+  // the slots that are not used yet have no room, so they are never found
+  memset(tree_, 0, sizeof(tree_));
+}
+
+page_id_t FreeSpaceMapPage::GetPageId() const { return page_id_; }
+
+page_id_t FreeSpaceMapPage::GetNextPageId() const { return next_page_id_; }
+
+void FreeSpaceMapPage::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+uint32_t FreeSpaceMapPage::GetSize() const { return size_; }
+
+bool FreeSpaceMapPage::IsFull() const { return size_ == SLOTS; }
+
+uint32_t FreeSpaceMapPage::Append(page_id_t table_page_id, uint32_t free_space) {
+  assert(!IsFull());
+  table_page_ids_[size_] = table_page_id;
+  SetFreeSpace(size_, free_space);
+  return size_++;
+}
+
+page_id_t FreeSpaceMapPage::TablePageIdAt(uint32_t slot) const { return table_page_ids_[slot]; }
+
+uint8_t FreeSpaceMapPage::CategoryAt(uint32_t slot) const { return tree_[SLOTS - 1 + slot]; }
+
+uint8_t FreeSpaceMapPage::GetMaxCategory() const { return tree_[0]; }
+
+void FreeSpaceMapPage::SetFreeSpace(uint32_t slot, uint32_t free_space) {
+  uint32_t node = SLOTS - 1 + slot;
+  tree_[node] = Category(free_space);
+  // update the maxima up to the root, or up to the first one that stays the same
+  while (node > 0) {
+    node = (node - 1) / 2;
+    uint8_t max = std::max(tree_[2 * node + 1], tree_[2 * node + 2]);
+    if (tree_[node] == max) {
+      break;
+    }
+    tree_[node] = max;
+  }
+}
+
+uint32_t FreeSpaceMapPage::Find(uint32_t space, uint32_t start) const {
+  uint32_t category = RequiredCategory(space);
+  if (category > GetMaxCategory()) {
+    return SLOTS;
+  }
+  uint32_t slot = FindFrom(std::min(start, SLOTS - 1), category);
+  // the root has room, so there is a slot before start if there is none after it
+  return slot < SLOTS ? slot : FindFrom(0, category);
+}
+
+uint32_t FreeSpaceMapPage::FindFrom(uint32_t start, uint32_t category) const {
+  uint32_t node = SLOTS - 1 + start;
+  if (tree_[node] >= category) {
+    return start;
+  }
+  // walk up until a right sibling, i.e. slots after start, has room
+  while (node % 2 == 0 || tree_[node + 1] < category) {
+    if (node == 0) {
+      return SLOTS;
+    }
+    node = (node - 1) / 2;
+  }
+  node++;
+  // and down to its first slot with room
+  while (node < SLOTS - 1) {
+    node = tree_[2 * node + 1] >= category ? 2 * node + 1 : 2 * node + 2;
+  }
+  return node - (SLOTS - 1);
+}
+
+}  // namespace bustub
@@ -0,0 +1,65 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_page.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_page.h"
+
+#include <cstring>
+
+namespace bustub {
+page_id_t HashTableDirectoryPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryPage::GetGlobalDepth() const { return global_depth_; }
+
+void HashTableDirectoryPage::SetGlobalDepth(uint32_t global_depth) {
+  assert(global_depth <= MAX_GLOBAL_DEPTH);
+  global_depth_ = global_depth;
+}
+
+uint32_t HashTableDirectoryPage::GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+uint32_t HashTableDirectoryPage::Size() const { return 1U << global_depth_; }
+
+page_id_t HashTableDirectoryPage::GetDirectoryPageId(uint32_t directory_page_idx) const {
+  return directory_page_ids_[directory_page_idx];
+}
+
+void HashTableDirectoryPage::SetDirectoryPageId(uint32_t directory_page_idx, page_id_t directory_page_id) {
+  directory_page_ids_[directory_page_idx] = directory_page_id;
+}
+
+page_id_t HashTableDirectoryPage::GetBucketPageId(uint32_t slot) const { return bucket_page_ids_[slot]; }
+
+void HashTableDirectoryPage::SetBucketPageId(uint32_t slot, page_id_t bucket_page_id) {
+  bucket_page_ids_[slot] = bucket_page_id;
+}
+
+uint32_t HashTableDirectoryPage::GetLocalDepth(uint32_t slot) const { return local_depths_[slot]; }
+
+void HashTableDirectoryPage::SetLocalDepth(uint32_t slot, uint32_t local_depth) {
+  assert(local_depth <= MAX_GLOBAL_DEPTH);
+  local_depths_[slot] = static_cast<uint8_t>(local_depth);
+}
+
+void HashTableDirectoryPage::CopySlots(const HashTableDirectoryPage &from, uint32_t from_slot, uint32_t to_slot,
+                                       uint32_t num_slots) {
+  assert(from_slot + num_slots <= DIRECTORY_ARRAY_SIZE && to_slot + num_slots <= DIRECTORY_ARRAY_SIZE);
+  memmove(local_depths_ + to_slot, from.local_depths_ + from_slot, num_slots * sizeof(uint8_t));
+  memmove(bucket_page_ids_ + to_slot, from.bucket_page_ids_ + from_slot, num_slots * sizeof(page_id_t));
+}
+
+}  // namespace bustub
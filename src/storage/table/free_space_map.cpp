@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/table/free_space_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/free_space_map.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+
+namespace bustub {
+
+page_id_t FreeSpaceMap::Create() {
+  std::unique_lock latch(latch_);
+  page_id_t page_id;
+  auto page = buffer_pool_manager_->NewPageInSegment(&page_id, segment_);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a free space map page.");
+  }
+  reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->Init(page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  map_page_ids_.push_back(page_id);
+  max_categories_.emplace_back(0);
+  return page_id;
+}
+
+void FreeSpaceMap::Attach(page_id_t first_page_id) {
+  std::unique_lock latch(latch_);
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto page = FetchMapPage(page_id);
+    auto map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+    for (uint32_t slot = 0; slot < map_page->GetSize(); slot++) {
+      last_table_page_id_ = map_page->TablePageIdAt(slot);
+      slots_[last_table_page_id_] = map_page_ids_.size() * FreeSpaceMapPage::SLOTS + slot;
+    }
+    map_page_ids_.push_back(page_id);
+    max_categories_.emplace_back(map_page->GetMaxCategory());
+    page_id_t next_page_id = map_page->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+}
+
+void FreeSpaceMap::Update(page_id_t table_page_id, uint32_t free_space) {
+  {
+    std::shared_lock latch(latch_);
+    auto iter = slots_.find(table_page_id);
+    if (iter != slots_.end()) {
+      SetFreeSpace(iter->second, free_space);
+      return;
+    }
+  }
+
+  // the table page is new, which changes the layout of the map
+  std::unique_lock latch(latch_);
+  auto iter = slots_.find(table_page_id);
+  if (iter != slots_.end()) {
+    SetFreeSpace(iter->second, free_space);
+    return;
+  }
+  auto last_page = FetchMapPage(map_page_ids_.back());
+  auto last_map_page = reinterpret_cast<FreeSpaceMapPage *>(last_page->GetData());
+  if (last_map_page->IsFull()) {
+    // start a new map page, linked from the last one
+    page_id_t page_id;
+    auto page = buffer_pool_manager_->NewPageInSegment(&page_id, segment_);
+    if (page == nullptr) {
+      buffer_pool_manager_->UnpinPage(last_page->GetPageId(), false);
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot allocate a free space map page.");
+    }
+    reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->Init(page_id);
+    last_map_page->SetNextPageId(page_id);
+    buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+    map_page_ids_.push_back(page_id);
+    max_categories_.emplace_back(0);
+    last_page = page;
+    last_map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+  }
+  last_page->WLatch();
+  uint32_t slot = last_map_page->Append(table_page_id, free_space);
+  max_categories_.back() = last_map_page->GetMaxCategory();
+  last_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(last_page->GetPageId(), true);
+  slots_[table_page_id] = (map_page_ids_.size() - 1) * FreeSpaceMapPage::SLOTS + slot;
+  last_table_page_id_ = table_page_id;
+}
+
+page_id_t FreeSpaceMap::FindPage(uint32_t space) {
+  std::shared_lock latch(latch_);
+  if (map_page_ids_.empty()) {
+    return INVALID_PAGE_ID;
+  }
+  uint32_t category = FreeSpaceMapPage::RequiredCategory(space);
+  uint32_t hint = hint_;
+  size_t num_pages = map_page_ids_.size();
+  size_t first = std::min<size_t>(hint / FreeSpaceMapPage::SLOTS, num_pages - 1);
+  // the map pages from the one of the hint on, wrapping around to the first one
+  for (size_t i = 0; i < num_pages; i++) {
+    size_t index = (first + i) % num_pages;
+    if (max_categories_[index] < category) {
+      continue;
+    }
+    auto page = FetchMapPage(map_page_ids_[index]);
+    auto map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+    page->RLatch();
+    uint32_t slot = map_page->Find(space, i == 0 ? hint % FreeSpaceMapPage::SLOTS : 0);
+    page_id_t table_page_id = slot < FreeSpaceMapPage::SLOTS ? map_page->TablePageIdAt(slot) : INVALID_PAGE_ID;
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (table_page_id != INVALID_PAGE_ID) {
+      hint_ = index * FreeSpaceMapPage::SLOTS + slot;
+      return table_page_id;
+    }
+  }
+  return INVALID_PAGE_ID;
+}
+
+page_id_t FreeSpaceMap::GetLastTablePageId() {
+  std::shared_lock latch(latch_);
+  return last_table_page_id_;
+}
+
+Page *FreeSpaceMap::FetchMapPage(page_id_t page_id) {
+  auto page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot fetch a free space map page.");
+  }
+  return page;
+}
+
+void FreeSpaceMap::SetFreeSpace(uint32_t slot, uint32_t free_space) {
+  size_t index = slot / FreeSpaceMapPage::SLOTS;
+  auto page = FetchMapPage(map_page_ids_[index]);
+  auto map_page = reinterpret_cast<FreeSpaceMapPage *>(page->GetData());
+  page->WLatch();
+  map_page->SetFreeSpace(slot % FreeSpaceMapPage::SLOTS, free_space);
+  max_categories_[index] = map_page->GetMaxCategory();
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+}
+
+}  // namespace bustub
@@ -22,13 +22,18 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      free_space_map_(buffer_pool_manager, &segment_) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
                      Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      free_space_map_(buffer_pool_manager, &segment_) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page =
+      reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPageInSegment(&first_page_id_, &segment_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
@@ -37,52 +42,85 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  if (TablePage::GetSpaceNeeded(tuple) > TablePage::GetMaxFreeSpace()) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  std::call_once(free_space_map_attached_, [this] { AttachFreeSpaceMap(); });
+  // Insert into a page the free space map says has enough space. The map may be stale when inserts race, but every
+  // attempt records the actual free space of the page, so a full page is not returned again.
+  uint32_t space = TablePage::GetSpaceNeeded(tuple);
+  for (auto page_id = free_space_map_.FindPage(space); page_id != INVALID_PAGE_ID;
+       page_id = free_space_map_.FindPage(space)) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    if (page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    page->WLatch();
+    bool inserted = page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
+    free_space_map_.Update(page_id, page->GetFreeSpaceRemaining());
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, inserted);
+    if (inserted) {
+      // Update the transaction's write set.
+      txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
+      return true;
+    }
+  }
+  // If no such page exists, create a new page and insert into that.
+  return InsertTupleAtEnd(tuple, rid, txn);
+}
+
+bool TableHeap::InsertTupleAtEnd(const Tuple &tuple, RID *rid, Transaction *txn) {
+  std::scoped_lock append_latch(append_latch_);
+  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id_));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
   cur_page->WLatch();
-  // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
-  // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
-    auto next_page_id = cur_page->GetNextPageId();
-    // If the next page is a valid page,
-    if (next_page_id != INVALID_PAGE_ID) {
-      // Unlatch and unpin the current page.
+  // The map pages are not logged, so pages appended before a crash may be missing from the map. Record them.
+  while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
+    page_id_t next_page_id = cur_page->GetNextPageId();
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id_, false);
+    cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    if (cur_page == nullptr) {
+      txn->SetState(TransactionState::ABORTED);
+      return false;
+    }
+    cur_page->WLatch();
+    free_space_map_.Update(next_page_id, cur_page->GetFreeSpaceRemaining());
+    last_page_id_ = next_page_id;
+  }
+  // Another insert may have appended a page while we waited for the latch, so try the last page first.
+  if (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+    page_id_t next_page_id;
+    auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPageInSegment(&next_page_id, &segment_));
+    // If we could not create a new page,
+    if (new_page == nullptr) {
+      // Then life sucks and we abort the transaction.
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-      // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
-      cur_page->WLatch();
-    } else {
-      // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
-      // If we could not create a new page,
-      if (new_page == nullptr) {
-        // Then life sucks and we abort the transaction.
-        cur_page->WUnlatch();
-        buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
-        txn->SetState(TransactionState::ABORTED);
-        return false;
-      }
-      // Otherwise we were able to create a new page. We initialize it now.
-      new_page->WLatch();
-      cur_page->SetNextPageId(next_page_id);
-      new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
-      cur_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
-      cur_page = new_page;
+      txn->SetState(TransactionState::ABORTED);
+      return false;
     }
+    // Otherwise we were able to create a new page. We initialize it now.
+    new_page->WLatch();
+    cur_page->SetNextPageId(next_page_id);
+    new_page->Init(next_page_id, PAGE_SIZE, cur_page->GetTablePageId(), log_manager_, txn);
+    free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetFreeSpaceRemaining());
+    cur_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+    cur_page = new_page;
+    last_page_id_ = next_page_id;
+    // A new page always has room, as the tuple is smaller than a page.
+    cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_);
   }
-  // This line has caused most of us to double-take and "whoa double unlatch".
-  // We are not, in fact, double unlatching. See the invariant above.
+  free_space_map_.Update(cur_page->GetTablePageId(), cur_page->GetFreeSpaceRemaining());
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
   // Update the transaction's write set.
@@ -90,6 +128,41 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
   return true;
 }
 
+void TableHeap::AttachFreeSpaceMap() {
+  std::scoped_lock append_latch(append_latch_);
+  auto first_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  BUSTUB_ASSERT(first_page != nullptr, "Couldn't fetch the first page of the table heap.");
+  first_page->WLatch();
+  page_id_t map_page_id = first_page->GetFreeSpaceMapPageId();
+  if (map_page_id != INVALID_PAGE_ID) {
+    first_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(first_page_id_, false);
+    free_space_map_.Attach(map_page_id);
+    last_page_id_ = free_space_map_.GetLastTablePageId();
+    if (last_page_id_ == INVALID_PAGE_ID) {
+      last_page_id_ = first_page_id_;
+    }
+    return;
+  }
+
+  // The table has no map yet, so build one from the free space of every page in the chain.
+  first_page->SetFreeSpaceMapPageId(free_space_map_.Create());
+  first_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(first_page_id_, true);
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    free_space_map_.Update(page_id, page->GetFreeSpaceRemaining());
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    last_page_id_ = page_id;
+    page_id = next_page_id;
+  }
+}
+
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
@@ -110,6 +183,7 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  std::call_once(free_space_map_attached_, [this] { AttachFreeSpaceMap(); });
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -121,6 +195,9 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   Tuple old_tuple;
   page->WLatch();
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    free_space_map_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
@@ -131,12 +208,15 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
 }
 
 void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
+  std::call_once(free_space_map_attached_, [this] { AttachFreeSpaceMap(); });
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
   page->WLatch();
+  // The page compacts its tuples, so the freed space can be used by inserts right away.
   page->ApplyDelete(rid, txn, log_manager_);
+  free_space_map_.Update(rid.GetPageId(), page->GetFreeSpaceRemaining());
   lock_manager_->Unlock(txn, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
@@ -169,24 +249,26 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
   auto page_id = first_page_id_;
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto next_page_id = page->GetNextPageId();
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
+      buffer_pool_manager_->PrefetchPage(next_page_id, strategy);
       break;
     }
-    page_id = page->GetNextPageId();
+    page_id = next_page_id;
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -11,13 +11,77 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
 #include <cstdio>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include "gtest/gtest.h"
 
 namespace bustub {
 
+// A disk manager whose reads of one page block until the test releases them.
+class BlockingDiskManager : public DiskManager {
+ public:
+  BlockingDiskManager(const std::string &db_file, page_id_t blocked_page_id)
+      : DiskManager(db_file), blocked_page_id_(blocked_page_id) {}
+
+  // make the buffer pool go through ReadPage instead of issuing reads on the file descriptor itself
+  int GetDatabaseFd() override { return -1; }
+
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == blocked_page_id_) {
+      std::unique_lock<std::mutex> lock(mutex_);
+      num_blocked_reads_++;
+      cv_.notify_all();
+      cv_.wait(lock, [&] { return released_; });
+    }
+    DiskManager::ReadPage(page_id, page_data);
+  }
+
+  void WaitForBlockedRead() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] { return num_blocked_reads_ > 0; });
+  }
+
+  void Release() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+  int GetNumBlockedReads() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return num_blocked_reads_;
+  }
+
+ private:
+  page_id_t blocked_page_id_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int num_blocked_reads_{0};
+  bool released_{false};
+};
+
+// A disk manager that gives the disk scheduler a descriptor of the database file that is opened for reading or for
+// writing only, so that the other kind of request fails.
+class OneWayDiskManager : public DiskManager {
+ public:
+  OneWayDiskManager(const std::string &db_file, int flags) : DiskManager(db_file), fd_(open(db_file.c_str(), flags)) {}
+
+  ~OneWayDiskManager() override { close(fd_); }
+
+  int GetDatabaseFd() override { return fd_; }
+
+ private:
+  int fd_;
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -187,8 +251,374 @@ TEST(BufferPoolManagerTest, RandomTest) {
   delete bpm;
   delete[] data;
   delete disk_manager;
+  remove("test.db");
 }
 
+TEST(BufferPoolManagerTest, RingBufferScanTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_scan_pages = 30;
+  const page_id_t num_hot_pages = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: write the pages of a table, then create a few hot pages that fill the rest of the pool.
+  for (page_id_t i = 0; i < num_scan_pages + num_hot_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+
+  // Scenario: scan the table with a ring buffer, holding the current page while fetching the next one.
+  BufferAccessStrategy strategy;
+  Page *prev_page = nullptr;
+  for (page_id_t i = 0; i < num_scan_pages; i++) {
+    Page *page = bpm->FetchPageWithStrategy(i, &strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    if (prev_page != nullptr) {
+      bpm->UnpinPage(prev_page->GetPageId(), false);
+    }
+    prev_page = page;
+  }
+  bpm->UnpinPage(prev_page->GetPageId(), false);
+
+  // The scan only recycled its own frames, so every hot page is still in the pool.
+  int num_resident_hot_pages = 0;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    if (bpm->GetPages()[i].GetPageId() >= num_scan_pages) {
+      num_resident_hot_pages++;
+    }
+  }
+  EXPECT_EQ(num_hot_pages, num_resident_hot_pages);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerTest, PageCleanerTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  bpm->StartPageCleaner(std::chrono::milliseconds(1), 4);
+
+  // Scenario: fill the pool with dirty, unpinned pages and give the cleaner time to write them.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  for (int i = 0; i < 1000 && bpm->GetBackgroundFlushCount() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundFlushCount());
+
+  // Scenario: the victims are clean now, so creating new pages does not write anything back.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, false);
+  }
+  EXPECT_EQ(0, bpm->GetForegroundFlushCount());
+
+  // Scenario: the pages written by the cleaner can be read back.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    bpm->UnpinPage(page_id, false);
+  }
+  bpm->StopPageCleaner();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerConcurrencyTest, MissDoesNotBlockHitTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new BlockingDiskManager(db_name, 0);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (int i = 0; i < 2; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+
+  // Scenario: two threads miss on page 0 at the same time, only one of them reads it from disk.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 2; tid++) {
+    threads.emplace_back([bpm]() {
+      Page *page = bpm->FetchPage(0);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+      EXPECT_TRUE(bpm->UnpinPage(0, false));
+    });
+  }
+  disk_manager->WaitForBlockedRead();
+
+  // Scenario: while the read of page 0 is stuck, pages that are already in the pool can still be fetched.
+  Page *page1 = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page1);
+  EXPECT_EQ(0, strcmp(page1->GetData(), "page 1"));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+
+  disk_manager->Release();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(1, disk_manager->GetNumBlockedReads());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedWriteTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new OneWayDiskManager(db_name, O_RDONLY);
+  auto *disk_scheduler = new DiskScheduler(disk_manager);
+  // only the io_uring backend issues its requests on the descriptor
+  if (disk_scheduler->GetBackend() != DiskScheduler::Backend::IO_URING) {
+    delete disk_scheduler;
+    delete disk_manager;
+    remove("test.db");
+    GTEST_SKIP();
+  }
+  auto *bpm = new BufferPoolManager(2, disk_manager, nullptr, ReplacerType::LRU, disk_scheduler);
+
+  page_id_t page_id0;
+  page_id_t page_id1;
+  page_id_t page_id2;
+  Page *page0 = bpm->NewPage(&page_id0);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "page 0");
+  EXPECT_TRUE(bpm->UnpinPage(page_id0, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id1));
+
+  // Scenario: the write-back of the dirty victim fails. No page is created and the victim stays in the pool, dirty.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id2));
+  EXPECT_EQ(1U, disk_manager->GetNumFreePages());
+  EXPECT_FALSE(bpm->FlushPage(page_id0));
+  page0 = bpm->FetchPage(page_id0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_STREQ("page 0", page0->GetData());
+  EXPECT_TRUE(page0->IsDirty());
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  EXPECT_TRUE(bpm->UnpinPage(page_id0, false));
+  EXPECT_TRUE(bpm->UnpinPage(page_id1, false));
+  delete bpm;
+  delete disk_scheduler;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedCleanerWriteTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new OneWayDiskManager(db_name, O_RDONLY);
+  auto *disk_scheduler = new DiskScheduler(disk_manager);
+  if (disk_scheduler->GetBackend() != DiskScheduler::Backend::IO_URING) {
+    delete disk_scheduler;
+    delete disk_manager;
+    remove("test.db");
+    GTEST_SKIP();
+  }
+  auto *bpm = new BufferPoolManager(1, disk_manager, nullptr, ReplacerType::LRU, disk_scheduler);
+
+  page_id_t page_id;
+  Page *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "page 0");
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Scenario: the cleaner fails to write the page for a few rounds, the page stays dirty and is not given up.
+  bpm->StartPageCleaner(std::chrono::milliseconds(1), 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  bpm->StopPageCleaner();
+  EXPECT_EQ(0, bpm->GetBackgroundFlushCount());
+  page_id_t new_page_id;
+  EXPECT_EQ(nullptr, bpm->NewPage(&new_page_id));
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("page 0", page->GetData());
+  EXPECT_TRUE(page->IsDirty());
+
+  EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  delete bpm;
+  delete disk_scheduler;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, FailedReadTest) {
+  const std::string db_name = "test.db";
+  auto *disk_manager = new OneWayDiskManager(db_name, O_WRONLY);
+  auto *disk_scheduler = new DiskScheduler(disk_manager);
+  if (disk_scheduler->GetBackend() != DiskScheduler::Backend::IO_URING) {
+    delete disk_scheduler;
+    delete disk_manager;
+    remove("test.db");
+    GTEST_SKIP();
+  }
+  auto *bpm = new BufferPoolManager(2, disk_manager, nullptr, ReplacerType::LRU, disk_scheduler);
+
+  page_id_t page_id0;
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id0));
+  EXPECT_TRUE(bpm->UnpinPage(page_id0, true));
+  EXPECT_TRUE(bpm->FlushPage(page_id0));
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  for (int i = 0; i < 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: reading the page back fails, so does the fetch, and the frame it was read into can be used again.
+  EXPECT_EQ(nullptr, bpm->FetchPage(page_id0));
+  for (int i = 0; i < 2; i++) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+
+  delete bpm;
+  delete disk_scheduler;
+  delete disk_manager;
+  remove("test.db");
+}
+
+TEST(BufferPoolManagerConcurrencyTest, PrefetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new BlockingDiskManager(db_name, 0);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (int i = 0; i < 3; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: prefetching returns while the read of page 0 is still stuck in the background.
+  bpm->PrefetchPages({0, 1, 2});
+  disk_manager->WaitForBlockedRead();
+
+  // Scenario: fetching the page that is being prefetched waits for that read instead of issuing another one.
+  std::thread fetcher([bpm]() {
+    Page *page = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "page 0"));
+    EXPECT_TRUE(bpm->UnpinPage(0, false));
+  });
+  disk_manager->Release();
+  fetcher.join();
+  EXPECT_EQ(1, disk_manager->GetNumBlockedReads());
+
+  // Scenario: the remaining pages can be fetched; the ones already prefetched are unpinned in the pool.
+  for (page_id = 1; page_id < 3; page_id++) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerConcurrencyTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new BlockingDiskManager(db_name, 1);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (int i = 0; i < 2; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+
+  // Scenario: a deleted page id is handed out again by the next NewPage.
+  EXPECT_TRUE(bpm->DeletePage(1));
+  EXPECT_EQ(1, disk_manager->GetNumFreePages());
+
+  // Scenario: a prefetch of the deleted page is still reading its old image when the id is reused.
+  bpm->PrefetchPage(1);
+  disk_manager->WaitForBlockedRead();
+  std::thread creator([bpm]() {
+    page_id_t new_page_id;
+    Page *page = bpm->NewPage(&new_page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(1, new_page_id);
+    EXPECT_EQ(0, page->GetData()[0]);
+    snprintf(page->GetData(), PAGE_SIZE, "new page");
+    EXPECT_TRUE(bpm->UnpinPage(new_page_id, true));
+  });
+  disk_manager->Release();
+  creator.join();
+
+  // Scenario: the stale image is gone, and evicting every other page never clobbers the new page.
+  for (int i = 0; i < 10; i++) {
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    bpm->UnpinPage(page_id, false);
+  }
+  Page *page = bpm->FetchPage(1);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "new page"));
+  EXPECT_TRUE(bpm->UnpinPage(1, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
 TEST(BufferPoolManagerConcurrencyTest, HardTest_4) {
   const int num_threads = 5;
   const int num_runs = 50;
@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include <cstdio>
+#include <string>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access six frames once, and frames 1 and 2 a second time.
+  for (frame_id_t i = 1; i <= 6; i++) {
+    lru_k_replacer.RecordAccess(i);
+  }
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  for (frame_id_t i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames accessed only once have an infinite backward 2-distance and go first, oldest access first.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames are not victimized.
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(3, lru_k_replacer.Size());
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+
+  // Scenario: among frames with two accesses, the one whose second most recent access is older goes first.
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, lru_k_replacer.Size());
+
+  // Scenario: a victimized frame starts over with an empty history.
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.RecordAccess(3);
+  lru_k_replacer.Unpin(3);
+  lru_k_replacer.Unpin(2);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedReferenceTest) {
+  LRUKReplacer lru_k_replacer(3, 2, 3);
+
+  // Scenario: a burst of accesses to frame 0 counts as a single access.
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(0);
+  lru_k_replacer.RecordAccess(0);
+  // Frame 1 is accessed twice, far enough apart to be uncorrelated.
+  lru_k_replacer.RecordAccess(1);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(2);
+  lru_k_replacer.RecordAccess(1);
+  for (frame_id_t i = 0; i < 3; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+
+  // Frame 0 has a single uncorrelated access and is outside its correlated period, so it goes first. Frames 2 and
+  // 1 are still inside their correlated periods, they are only evicted because nothing else is left.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+
+  // Scenario: pages 0 and 1 are accessed twice.
+  page_id_t page_id;
+  for (page_id_t hot_page_id = 0; hot_page_id < 2; hot_page_id++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(hot_page_id, page_id);
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a scan touches many pages once each. It must only cycle through the remaining frames.
+  for (int i = 0; i < 20; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    ASSERT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  int num_hot_pages = 0;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    page_id_t resident_page_id = bpm->GetPages()[i].GetPageId();
+    if (resident_page_id == 0 || resident_page_id == 1) {
+      num_hot_pages++;
+    }
+  }
+  EXPECT_EQ(2, num_hot_pages);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_benchmark.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+/**
+ * Measures the throughput of concurrent fetches and unpins of resident pages, for a single buffer pool instance and for
+ * a parallel buffer pool of the same total size with one instance per thread.
+ */
+namespace bustub {
+
+double RunFetchWorkload(BufferPoolManager *bpm, size_t num_threads, size_t num_pages, size_t num_ops) {
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      std::printf("could not create page %zu\n", i);
+      std::exit(1);
+    }
+    bpm->UnpinPage(page_id, true);
+    page_ids.push_back(page_id);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < num_ops; i++) {
+        page_id_t page_id = page_ids[dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        while (page == nullptr) {
+          page = bpm->FetchPage(page_id);
+        }
+        page->RLatch();
+        page->RUnlatch();
+        bpm->UnpinPage(page_id, false);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(num_threads * num_ops) / elapsed.count();
+}
+
+}  // namespace bustub
+
+int main() {
+  const size_t num_threads = 8;
+  const size_t num_pages = 64;
+  const size_t num_ops = 1000000;
+
+  {
+    auto disk_manager = std::make_unique<bustub::DiskManager>("benchmark.db");
+    auto bpm = std::make_unique<bustub::BufferPoolManager>(num_pages, disk_manager.get());
+    double throughput = bustub::RunFetchWorkload(bpm.get(), num_threads, num_pages, num_ops);
+    std::printf("1 instance: %.0f ops/s\n", throughput);
+    disk_manager->ShutDown();
+    std::remove("benchmark.db");
+  }
+  {
+    auto disk_manager = std::make_unique<bustub::DiskManager>("benchmark.db");
+    auto bpm = std::make_unique<bustub::ParallelBufferPoolManager>(num_threads, num_pages / num_threads,
+                                                                   disk_manager.get());
+    double throughput = bustub::RunFetchWorkload(bpm.get(), num_threads, num_pages, num_ops);
+    std::printf("%zu instances: %.0f ops/s\n", num_threads, throughput);
+    disk_manager->ShutDown();
+  }
+  std::remove("benchmark.db");
+  std::remove("benchmark.log");
+  return 0;
+}
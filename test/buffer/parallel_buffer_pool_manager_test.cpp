@@ -0,0 +1,167 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 5;
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+
+  // Scenario: The buffer pool is empty. We should be able to create a new page.
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, page_id_temp);
+
+  // Scenario: Once we have a page, we should be able to read and write content.
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+
+  // Scenario: Page ids are handed out round-robin over the instances, so we can fill up every frame.
+  for (size_t i = 1; i < num_instances * buffer_pool_size; ++i) {
+    EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+
+  // Scenario: Once the buffer pool is full, we should not be able to create any new pages.
+  for (size_t i = 0; i < num_instances; ++i) {
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+  }
+
+  // Scenario: After unpinning page 0, it can be evicted from its instance and read back later.
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(0, page_id_temp % static_cast<page_id_t>(num_instances));
+  EXPECT_EQ(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  page0 = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page0);
+  EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, PersistenceTest) {
+  const std::string db_name = "test.db";
+  const size_t num_pages = 100;
+
+  auto *disk_manager = new DiskManager(db_name);
+  BufferPoolManager *bpm = new ParallelBufferPoolManager(4, 3, disk_manager);
+
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page %zu", i);
+    bpm->UnpinPage(page_id, true);
+  }
+  bpm->FlushAllPages();
+  delete bpm;
+
+  bpm = new ParallelBufferPoolManager(3, 4, disk_manager);
+  for (size_t i = 0; i < num_pages; i++) {
+    Page *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    bpm->UnpinPage(i, false);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrentTest) {
+  const size_t num_threads = 8;
+  const size_t num_pages = 64;
+  const size_t num_ops = 20000;
+
+  auto disk_manager = std::make_unique<DiskManager>("test.db");
+  auto bpm = std::make_unique<ParallelBufferPoolManager>(num_threads, num_pages / num_threads, disk_manager.get());
+
+  // Scenario: filling the pool spreads the pages evenly over the instances, by page id.
+  std::vector<page_id_t> page_ids;
+  std::vector<size_t> pages_per_instance(num_threads, 0);
+  for (size_t i = 0; i < num_pages; i++) {
+    page_id_t page_id;
+    Page *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+    pages_per_instance[page_id % num_threads]++;
+  }
+  for (auto num_instance_pages : pages_per_instance) {
+    EXPECT_EQ(num_pages / num_threads, num_instance_pages);
+  }
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (auto page_id : page_ids) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: threads fetching pages of every instance at once always see the page they asked for.
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid]() {
+      std::mt19937 rng(tid);
+      std::uniform_int_distribution<size_t> dist(0, page_ids.size() - 1);
+      for (size_t i = 0; i < num_ops; i++) {
+        page_id_t page_id = page_ids[dist(rng)];
+        Page *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        page->RLatch();
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0U, bpm->GetForegroundFlushCount());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
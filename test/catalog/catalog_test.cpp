@@ -102,4 +102,125 @@ TEST(GradingCatalogTest, CreateIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST(CatalogTest, NonUniqueIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+  // the index records its root in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  Schema schema({Column("A", TypeId::INTEGER), Column("B", TypeId::INTEGER)});
+  Schema key_schema({Column("A", TypeId::INTEGER)});
+  auto *table_metadata = catalog->CreateTable(&txn, "t", schema);
+  // ten rows for every value of A
+  for (int i = 0; i < 100; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i % 10), ValueFactory::GetIntegerValue(i)}, &schema);
+    RID rid;
+    table_metadata->table_->InsertTuple(tuple, &rid, &txn);
+  }
+
+  auto index_info = catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(&txn, "index_a", "t", schema,
+                                                                                     key_schema, {0}, 16, false);
+  EXPECT_FALSE(index_info->index_->IsUnique());
+  auto scan_key = [&](int a) {
+    Tuple key({ValueFactory::GetIntegerValue(a)}, &key_schema);
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(key, &rids, &txn);
+    std::unordered_set<int> values;
+    for (auto rid : rids) {
+      Tuple tuple;
+      table_metadata->table_->GetTuple(rid, &tuple, &txn);
+      EXPECT_EQ(a, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+      values.insert(tuple.GetValue(&schema, 1).GetAs<int32_t>());
+    }
+    EXPECT_EQ(rids.size(), values.size());
+    return values;
+  };
+  for (int a = 0; a < 10; a++) {
+    EXPECT_EQ(10U, scan_key(a).size());
+  }
+  EXPECT_TRUE(scan_key(-1).empty());
+  EXPECT_TRUE(scan_key(10).empty());
+
+  // a new row with an existing key, and removing one of the existing rows
+  Tuple tuple({ValueFactory::GetIntegerValue(3), ValueFactory::GetIntegerValue(100)}, &schema);
+  RID rid;
+  table_metadata->table_->InsertTuple(tuple, &rid, &txn);
+  index_info->index_->InsertEntry(tuple.KeyFromTuple(schema, key_schema, {0}), rid, &txn);
+  auto values = scan_key(3);
+  EXPECT_EQ(11U, values.size());
+  EXPECT_EQ(1U, values.count(100));
+
+  auto iter = table_metadata->table_->Begin(&txn);
+  while (iter->GetValue(&schema, 0).GetAs<int32_t>() != 3) {
+    ++iter;
+  }
+  index_info->index_->DeleteEntry(iter->KeyFromTuple(schema, key_schema, {0}), iter->GetRid(), &txn);
+  values = scan_key(3);
+  EXPECT_EQ(10U, values.size());
+  EXPECT_EQ(0U, values.count(iter->GetValue(&schema, 1).GetAs<int32_t>()));
+  EXPECT_EQ(10U, scan_key(4).size());
+
+  // the key columns have to fit in front of the RID, or keys that only differ past them would match each other
+  Schema varchar_key_schema({Column("A", TypeId::VARCHAR, 8)});
+  EXPECT_THROW((catalog->CreateIndex<GenericKey<16>, RID, GenericComparator<16>>(&txn, "index_v", "t", schema,
+                                                                                 varchar_key_schema, {0}, 16, false)),
+               Exception);
+
+  remove("catalog_test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, HashIndexTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManager>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  Transaction txn(0);
+
+  Schema schema({Column("A", TypeId::INTEGER), Column("B", TypeId::INTEGER)});
+  Schema key_schema({Column("A", TypeId::INTEGER)});
+  auto *table_metadata = catalog->CreateTable(&txn, "t", schema);
+  // ten rows for every value of A, more than the initial buckets of the index
+  for (int i = 0; i < 2000; i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(i % 200), ValueFactory::GetIntegerValue(i)}, &schema);
+    RID rid;
+    table_metadata->table_->InsertTuple(tuple, &rid, &txn);
+  }
+
+  for (auto index_type : {IndexType::Hash, IndexType::ExtendibleHash}) {
+    auto index_info = catalog->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+        &txn, "index_a" + std::to_string(static_cast<int>(index_type)), "t", schema, key_schema, {0}, 8, false,
+        index_type);
+    EXPECT_EQ(index_type, index_info->index_->GetMetadata()->GetIndexType());
+    auto scan_key = [&](int a) {
+      Tuple key({ValueFactory::GetIntegerValue(a)}, &key_schema);
+      std::vector<RID> rids;
+      index_info->index_->ScanKey(key, &rids, &txn);
+      std::unordered_set<int> values;
+      for (auto rid : rids) {
+        Tuple tuple;
+        table_metadata->table_->GetTuple(rid, &tuple, &txn);
+        EXPECT_EQ(a, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+        values.insert(tuple.GetValue(&schema, 1).GetAs<int32_t>());
+      }
+      EXPECT_EQ(rids.size(), values.size());
+      return values;
+    };
+    for (int a = 0; a < 200; a++) {
+      EXPECT_EQ(10U, scan_key(a).size());
+    }
+    EXPECT_TRUE(scan_key(200).empty());
+
+    auto iter = table_metadata->table_->Begin(&txn);
+    index_info->index_->DeleteEntry(iter->KeyFromTuple(schema, key_schema, {0}), iter->GetRid(), &txn);
+    EXPECT_EQ(9U, scan_key(iter->GetValue(&schema, 0).GetAs<int32_t>()).size());
+  }
+
+  remove("catalog_test.db");
+}
+
 }  // namespace bustub
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_util_test.cpp
+//
+// Identification: test/common/hash_util_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/plans/aggregation_plan.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(HashUtilTest, HashBytesTest) {
+  // every length takes a different path through the short, medium and long input cases
+  std::string bytes;
+  for (int i = 0; i < 200; i++) {
+    bytes.push_back(static_cast<char>(i * 7));
+  }
+  std::unordered_set<hash_t> hashes;
+  for (size_t length = 0; length <= bytes.size(); length++) {
+    hash_t hash = HashUtil::HashBytes(bytes.data(), length);
+    EXPECT_EQ(hash, HashUtil::HashBytes(std::string(bytes, 0, length).data(), length));
+    EXPECT_NE(hash, HashUtil::HashBytes(bytes.data(), length, 1));
+    hashes.insert(hash);
+
+    // flipping any single bit changes the hash
+    std::string flipped(bytes, 0, length);
+    for (size_t i = 0; i < length; i++) {
+      flipped[i] ^= 1;
+      hashes.insert(HashUtil::HashBytes(flipped.data(), length));
+      flipped[i] ^= 1;
+    }
+  }
+  EXPECT_EQ(201U + 200U * 201U / 2, hashes.size());
+
+  // strings of zero bytes only differ in length
+  std::string zeros(100, '\0');
+  hashes.clear();
+  for (size_t length = 0; length <= zeros.size(); length++) {
+    hashes.insert(HashUtil::HashBytes(zeros.data(), length));
+  }
+  EXPECT_EQ(101U, hashes.size());
+}
+
+// NOLINTNEXTLINE
+TEST(HashUtilTest, HashValuesTest) {
+  std::vector<Value> ints;
+  std::vector<Value> strings;
+  for (int i = 0; i < 100; i++) {
+    ints.push_back(i % 7 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i));
+    strings.push_back(ValueFactory::GetVarcharValue(std::string(i % 30, static_cast<char>('a' + i % 26))));
+  }
+
+  std::vector<hash_t> hashes(ints.size());
+  HashUtil::HashValues(strings.data(), strings.size(), hashes.data());
+  for (size_t i = 0; i < strings.size(); i++) {
+    EXPECT_EQ(HashUtil::HashValue(&strings[i]), hashes[i]);
+  }
+  HashUtil::HashValues(ints.data(), ints.size(), hashes.data());
+  for (size_t i = 0; i < ints.size(); i++) {
+    EXPECT_EQ(ints[i].IsNull() ? 0 : HashUtil::HashValue(&ints[i]), hashes[i]);
+  }
+
+  // combining column by column gives the hashes of the row-wise aggregate keys
+  std::fill(hashes.begin(), hashes.end(), 0);
+  HashUtil::CombineHashValues(ints.data(), ints.size(), hashes.data());
+  HashUtil::CombineHashValues(strings.data(), strings.size(), hashes.data());
+  for (size_t i = 0; i < ints.size(); i++) {
+    AggregateKey key{{ints[i], strings[i]}};
+    EXPECT_EQ(std::hash<AggregateKey>{}(key), hashes[i]);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_test.cpp
+//
+// Identification: test/container/extendible_hash_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/logger.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+#include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // duplicate pairs are not allowed, but more values for a key are
+  for (int i = 0; i < 5; i++) {
+    EXPECT_FALSE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i + 1));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    ASSERT_EQ(2, res.size());
+    EXPECT_TRUE((res[0] == i && res[1] == 2 * i + 1) || (res[0] == 2 * i + 1 && res[1] == i));
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  EXPECT_FALSE(ht.GetValue(nullptr, 20, &res));
+  EXPECT_EQ(0, res.size());
+
+  // delete all values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    EXPECT_FALSE(ht.Remove(nullptr, i, i));
+    EXPECT_TRUE(ht.Remove(nullptr, i, 2 * i + 1));
+    std::vector<int> res;
+    EXPECT_FALSE(ht.GetValue(nullptr, i, &res));
+  }
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, SplitMergeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // more pairs than a few buckets hold split them, and the directory grows with them
+  const int num_keys = 20000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  // a bucket holds 504 pairs of two ints, the pairs need at least 40 buckets
+  uint32_t global_depth = ht.GetGlobalDepth();
+  EXPECT_GE(global_depth, 6U);
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // empty buckets are merged, and the directory shrinks again
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+  }
+  EXPECT_EQ(0U, ht.GetGlobalDepth());
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, -i));
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(-i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, OverflowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // the values of a key fill several pages, which no split can tell apart, so the bucket gets overflow pages
+  const int num_values = 2000;
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, 7, i));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, 7, num_values - 1));
+  EXPECT_EQ(0U, ht.GetGlobalDepth());
+  // other keys still split the buckets around it
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i + 100, i));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 0U);
+
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 7, &res));
+  ASSERT_EQ(num_values, res.size());
+  std::sort(res.begin(), res.end());
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_EQ(i, res[i]);
+  }
+
+  // the overflow pages go away with their pairs, and the buckets merge again
+  for (int i = 0; i < num_values; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, 7, i));
+    EXPECT_TRUE(ht.Remove(nullptr, i + 100, i));
+  }
+  EXPECT_EQ(0U, ht.GetGlobalDepth());
+  res.clear();
+  EXPECT_FALSE(ht.GetValue(nullptr, 7, &res));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, LargeDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // wide keys leave few pairs per bucket, so the directory outgrows its first page
+  Schema schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<64> comparator(&schema);
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator,
+                                                                     HashFunction<GenericKey<64>>());
+  const int64_t num_keys = 30000;
+  GenericKey<64> key;
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Insert(nullptr, key, RID(i)));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), 9U);
+  for (int64_t i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    key.SetFromInteger(i);
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(RID(i), res[0]);
+  }
+
+  // and gives the pages up again when it shrinks
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Remove(nullptr, key, RID(i)));
+  }
+  EXPECT_EQ(0U, ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// NOLINTNEXTLINE
+TEST(ExtendibleHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // every thread inserts its own keys, and removes half of them again, while the others split and merge buckets
+  const int num_threads = 4;
+  const int num_keys = 5000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_keys * num_threads; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        EXPECT_FALSE(ht.Insert(nullptr, i, i));
+      }
+      for (int i = t; i < num_keys * num_threads; i += 2 * num_threads) {
+        EXPECT_TRUE(ht.Remove(nullptr, i, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_keys * num_threads; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i % (2 * num_threads) < num_threads) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
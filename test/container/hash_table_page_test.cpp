@@ -18,12 +18,14 @@
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_block_page.h"
+#include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_page.h"
 #include "storage/page/hash_table_header_page.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
+TEST(HashTablePageTest, HeaderPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -39,6 +41,8 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
     EXPECT_EQ(i, header_page->GetPageId());
     header_page->SetLSN(i);
     EXPECT_EQ(i, header_page->GetLSN());
+    header_page->SetNextPageId(i);
+    EXPECT_EQ(i, header_page->GetNextPageId());
   }
 
   // add a few hypothetical block pages
@@ -61,7 +65,7 @@ TEST(HashTablePageTest, DISABLED_HeaderPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
+TEST(HashTablePageTest, BlockPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(5, disk_manager);
 
@@ -73,7 +77,7 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    block_page->Insert(i, i, i);
+    block_page->Insert(i, i, i, HashTableBlockPage<int, int, IntComparator>::Fingerprint(i));
   }
 
   // check for the inserted pairs
@@ -111,4 +115,136 @@ TEST(HashTablePageTest, DISABLED_BlockPageSampleTest) {
   delete bpm;
 }
 
+TEST(HashTablePageTest, BlockPageFingerprintTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+  using BlockPage = HashTableBlockPage<int, int, IntComparator>;
+
+  page_id_t block_page_id = INVALID_PAGE_ID;
+  auto block_page = reinterpret_cast<BlockPage *>(bpm->NewPage(&block_page_id, nullptr)->GetData());
+
+  // pairs with two fingerprints, across several groups of fingerprints
+  uint8_t fingerprint = BlockPage::Fingerprint(uint64_t{5} << 57);
+  uint8_t other_fingerprint = BlockPage::Fingerprint(uint64_t{6} << 57);
+  for (unsigned i = 0; i < 100; i++) {
+    block_page->Insert(i, i, i, i % 3 == 0 ? fingerprint : other_fingerprint);
+  }
+  block_page->Remove(30);
+
+  auto probe = [&](slot_offset_t begin, slot_offset_t end, std::vector<slot_offset_t> *visited) {
+    return block_page->ProbeFingerprints(begin, end, fingerprint, [&](slot_offset_t slot) {
+      visited->push_back(slot);
+      return false;
+    });
+  };
+  // the scan stops at the first unoccupied index, and skips the tombstone
+  std::vector<slot_offset_t> visited;
+  EXPECT_EQ(100, probe(10, 200, &visited));
+  std::vector<slot_offset_t> expected;
+  for (slot_offset_t i = 12; i < 100; i += 3) {
+    if (i != 30) {
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(expected, visited);
+
+  // or at the end of the range
+  visited.clear();
+  EXPECT_EQ(40, probe(33, 40, &visited));
+  EXPECT_EQ((std::vector<slot_offset_t>{33, 36, 39}), visited);
+
+  // or where the visitor wants it to
+  visited.clear();
+  EXPECT_EQ(6, block_page->ProbeFingerprints(1, 100, fingerprint, [&](slot_offset_t slot) { return slot == 6; }));
+
+  bpm->UnpinPage(block_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTablePageTest, DirectoryPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  auto directory_page =
+      reinterpret_cast<HashTableDirectoryPage *>(bpm->NewPage(&directory_page_id, nullptr)->GetData());
+  EXPECT_EQ(0, directory_page->GetGlobalDepth());
+  directory_page->SetBucketPageId(0, 10);
+
+  // doubling the directory copies its lower half to the upper half
+  directory_page->CopySlots(*directory_page, 0, 1, 1);
+  directory_page->SetGlobalDepth(1);
+  EXPECT_EQ(2, directory_page->Size());
+  EXPECT_EQ(1, directory_page->GetGlobalDepthMask());
+  EXPECT_EQ(10, directory_page->GetBucketPageId(1));
+
+  // split the bucket
+  directory_page->SetBucketPageId(1, 11);
+  directory_page->SetLocalDepth(0, 1);
+  directory_page->SetLocalDepth(1, 1);
+  directory_page->CopySlots(*directory_page, 0, 2, 2);
+  directory_page->SetGlobalDepth(2);
+  EXPECT_EQ(4, directory_page->Size());
+  EXPECT_EQ(10, directory_page->GetBucketPageId(2));
+  EXPECT_EQ(11, directory_page->GetBucketPageId(3));
+  EXPECT_EQ(1, directory_page->GetLocalDepth(3));
+
+  // the first page lists the pages of a directory too large for it
+  directory_page->SetDirectoryPageId(0, directory_page_id);
+  directory_page->SetDirectoryPageId(1, 12);
+  EXPECT_EQ(directory_page_id, directory_page->GetDirectoryPageId(0));
+  EXPECT_EQ(12, directory_page->GetDirectoryPageId(1));
+
+  bpm->UnpinPage(directory_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTablePageTest, BucketPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  bucket_page->Init();
+  EXPECT_TRUE(bucket_page->IsEmpty());
+  EXPECT_EQ(INVALID_PAGE_ID, bucket_page->GetNextPageId());
+
+  // insert a few (key, value) pairs, two for each key
+  for (int i = 0; i < 10; i++) {
+    EXPECT_TRUE(bucket_page->Insert(i / 2, i, IntComparator()));
+  }
+  EXPECT_FALSE(bucket_page->Insert(0, 0, IntComparator()));
+  EXPECT_EQ(10, bucket_page->NumReadable());
+  EXPECT_TRUE(bucket_page->Contains(0, 1, IntComparator()));
+  EXPECT_FALSE(bucket_page->Contains(0, 2, IntComparator()));
+
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(bucket_page->GetValue(i, IntComparator(), &res));
+    EXPECT_EQ((std::vector<int>{2 * i, 2 * i + 1}), res);
+  }
+
+  // a removed pair frees its index for the next insert
+  EXPECT_TRUE(bucket_page->Remove(0, 1, IntComparator()));
+  EXPECT_FALSE(bucket_page->Remove(0, 1, IntComparator()));
+  EXPECT_FALSE(bucket_page->IsReadable(1));
+  EXPECT_TRUE(bucket_page->Insert(7, 7, IntComparator()));
+  EXPECT_TRUE(bucket_page->IsReadable(1));
+  EXPECT_EQ(7, bucket_page->KeyAt(1));
+  EXPECT_FALSE(bucket_page->IsFull());
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -17,11 +17,12 @@
 #include "container/hash/linear_probe_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "storage/index/generic_key.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManager(50, disk_manager);
 
@@ -104,4 +105,169 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+TEST(HashTableTest, ResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // a single block, which fills up after a few hundred pairs
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  const int num_keys = 5000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    EXPECT_TRUE(ht.Insert(nullptr, i, -i - 1));
+  }
+  EXPECT_GE(ht.GetSize(), 2 * num_keys);
+  EXPECT_GT(ht.GetSize(), initial_size);
+
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, i, &res));
+    ASSERT_EQ(2, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_TRUE((res[0] == i && res[1] == -i - 1) || (res[0] == -i - 1 && res[1] == i));
+    if (i % 2 == 0) {
+      EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    }
+  }
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(i % 2 == 0 ? 1 : 2, res.size());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, HeaderPageChainTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  // wide keys leave few buckets per block, so the table needs more blocks than one header page lists
+  Schema schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<64> comparator(&schema);
+  LinearProbeHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator, 10,
+                                                                      HashFunction<GenericKey<64>>());
+  using KeyType = GenericKey<64>;
+  using ValueType = RID;
+  const size_t num_buckets = HashTableHeaderPage::MaxNumBlocks() * BLOCK_ARRAY_SIZE;
+  const int64_t num_keys = 1000;
+  GenericKey<64> key;
+  for (int64_t i = 0; i < num_keys; i++) {
+    key.SetFromInteger(i);
+    EXPECT_TRUE(ht.Insert(nullptr, key, RID(i)));
+  }
+  ht.Resize(num_buckets / 2 + 1);
+  EXPECT_GT(ht.GetSize(), num_buckets);
+  // the table is the first thing in the database, so page 0 is its first header page
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(bpm->FetchPage(0)->GetData());
+  EXPECT_EQ(HashTableHeaderPage::MaxNumBlocks(), header_page->NumBlocks());
+  EXPECT_NE(INVALID_PAGE_ID, header_page->GetNextPageId());
+  bpm->UnpinPage(0, false);
+  for (int64_t i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    key.SetFromInteger(i);
+    ASSERT_TRUE(ht.GetValue(nullptr, key, &res));
+    ASSERT_EQ(1, res.size());
+    EXPECT_EQ(RID(i), res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, ResizeOutOfMemoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  const size_t pool_size = 10;
+  auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+
+  // the table is the first thing in the database, so its header page and its single block are the pages 0 and 1;
+  // together with them, all frames are pinned, so a resize can't allocate blocks while inserts still find the block
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+  std::vector<page_id_t> pinned(pool_size - 2);
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  for (auto &page_id : pinned) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  pinned.push_back(0);
+  pinned.push_back(1);
+  int num_keys = 0;
+  EXPECT_THROW(
+      {
+        while (num_keys < 10000) {
+          ht.Insert(nullptr, num_keys, num_keys);
+          num_keys++;
+        }
+      },
+      Exception);
+  // the insert that failed to resize still inserted its pair
+  num_keys++;
+
+  // the table was left as it was, and resizes once there are frames again
+  for (auto page_id : pinned) {
+    bpm->UnpinPage(page_id, false);
+  }
+  for (int i = num_keys; i < 2 * num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+  }
+  for (int i = 0; i < 2 * num_keys; i++) {
+    std::vector<int> res;
+    ASSERT_TRUE(ht.GetValue(nullptr, i, &res));
+    EXPECT_EQ(i, res[0]);
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(50, disk_manager);
+
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 10, HashFunction<int>());
+
+  // every thread inserts its own keys, and removes half of them again, while the others resize the table
+  const int num_threads = 4;
+  const int num_keys = 2000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&ht, t]() {
+      for (int i = t; i < num_keys * num_threads; i += num_threads) {
+        EXPECT_TRUE(ht.Insert(nullptr, i, i));
+        EXPECT_FALSE(ht.Insert(nullptr, i, i));
+      }
+      for (int i = t; i < num_keys * num_threads; i += 2 * num_threads) {
+        EXPECT_TRUE(ht.Remove(nullptr, i, i));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  for (int i = 0; i < num_keys * num_threads; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i % (2 * num_threads) < num_threads) {
+      EXPECT_EQ(0, res.size());
+    } else {
+      ASSERT_EQ(1, res.size());
+      EXPECT_EQ(i, res[0]);
+    }
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -32,6 +32,8 @@
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/index_scan_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "gtest/gtest.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
@@ -104,6 +106,12 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
+  const AbstractExpression *MakeLogicExpression(const AbstractExpression *lhs, const AbstractExpression *rhs,
+                                                LogicType logic_type) {
+    allocated_exprs_.emplace_back(std::make_unique<LogicExpression>(lhs, rhs, logic_type));
+    return allocated_exprs_.back().get();
+  }
+
   const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx) {
     allocated_exprs_.emplace_back(
         std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, TypeId::INTEGER));
@@ -335,6 +343,51 @@ TEST_F(ExecutorTest, SimpleRawInsertWithIndexTest) {
   delete key_schema;
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, IndexRangeScanTest) {
+  // SELECT colA, colB FROM test_1 WHERE colA >= 100 AND 600 > colA ORDER BY colA [DESC]
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  auto index_info = GetExecutorContext()->GetCatalog()->CreateIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      GetTxn(), "index1", "test_1", table_info->schema_, *key_schema, {0}, 8);
+
+  auto &schema = table_info->schema_;
+  auto *colA = MakeColumnValueExpression(schema, 0, "colA");
+  auto *colB = MakeColumnValueExpression(schema, 0, "colB");
+  auto *lower = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                                         ComparisonType::GreaterThanOrEqual);
+  auto *upper = MakeComparisonExpression(MakeConstantValueExpression(ValueFactory::GetIntegerValue(600)), colA,
+                                         ComparisonType::GreaterThan);
+  auto *predicate = MakeLogicExpression(lower, upper, LogicType::And);
+  auto *out_schema = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+
+  for (bool descending : {false, true}) {
+    IndexScanPlanNode plan{out_schema, predicate, index_info->index_oid_, descending};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+
+    ASSERT_EQ(500U, result_set.size());
+    for (size_t i = 0; i < result_set.size(); i++) {
+      int32_t expected = descending ? static_cast<int32_t>(599 - i) : static_cast<int32_t>(100 + i);
+      ASSERT_EQ(expected, result_set[i].GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+    }
+  }
+
+  // a disjunction doesn't bound the scan, but the predicate still applies
+  auto *small = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(10)),
+                                         ComparisonType::LessThan);
+  auto *large = MakeComparisonExpression(colA, MakeConstantValueExpression(ValueFactory::GetIntegerValue(990)),
+                                         ComparisonType::GreaterThan);
+  IndexScanPlanNode plan{out_schema, MakeLogicExpression(small, large, LogicType::Or), index_info->index_oid_, true};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(19U, result_set.size());
+  EXPECT_EQ(999, result_set.front().GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+  EXPECT_EQ(0, result_set.back().GetValue(out_schema, out_schema->GetColIdx("colA")).GetAs<int32_t>());
+
+  delete key_schema;
+}
+
 // NOLINTNEXTLINE
 TEST_F(ExecutorTest, SimpleDeleteTest) {
   // SELECT colA FROM test_1 WHERE colA == 50
@@ -2,7 +2,7 @@
  * b_plus_tree_test.cpp
  */
 
-#include <chrono>  // NOLINT
+#include <atomic>
 #include <cstdio>
 #include <functional>
 #include <thread>                   // NOLINT
@@ -29,6 +29,19 @@ void LaunchParallelTest(uint64_t num_threads, Args &&...args) {
   }
 }
 
+// buffer pool that counts the pages fetched through its latch
+class CountingBufferPoolManager : public BufferPoolManager {
+ public:
+  using BufferPoolManager::BufferPoolManager;
+  std::atomic<size_t> num_fetches_{0};
+
+ protected:
+  Page *FetchPageImpl(page_id_t page_id) override {
+    num_fetches_++;
+    return BufferPoolManager::FetchPageImpl(page_id);
+  }
+};
+
 // helper function to insert
 void InsertHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, const std::vector<int64_t> &keys,
                   __attribute__((unused)) uint64_t thread_itr = 0) {
@@ -330,4 +343,183 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, OptimisticLookupTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new CountingBufferPoolManager(1024, disk_manager);
+  // create b+ tree with small pages, so that it has several levels but still fits into the buffer pool
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 16, 16);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // the even keys are there from the start, the odd keys are inserted while the lookups run
+  const int64_t num_keys = 4000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // Scenario: lookups that race with splits caused by a writer still find every key that was there all along.
+  std::atomic<bool> done{false};
+  auto lookup = [&](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    int64_t key = thread_itr * 2;
+    size_t num_lookups = 0;
+    while (!done || num_lookups < 1000) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(1U, rids.size());
+      key = (key + 14) % num_keys;
+      num_lookups++;
+    }
+  };
+  std::vector<std::thread> readers;
+  for (uint64_t i = 0; i < 3; i++) {
+    readers.emplace_back(lookup, i);
+  }
+  keys.clear();
+  for (int64_t key = 1; key < num_keys; key += 2) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // Scenario: once the tree is in the buffer pool, read-only lookups find every key without fetching pages through
+  // the buffer pool latch, except for the few pages that cannot be found without it.
+  const size_t num_lookups = 20000;
+  const uint64_t num_threads = 4;
+  bpm->num_fetches_ = 0;
+  LaunchParallelTest(num_threads, [&](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (size_t i = 0; i < num_lookups / num_threads; i++) {
+      int64_t key = (i * 7 + thread_itr) % num_keys;
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(key, rids[0].GetSlotNum());
+    }
+  });
+  EXPECT_LT(bpm->num_fetches_.load(), num_lookups / 20);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, BLinkTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(256, disk_manager);
+  // create b+ link tree with small pages, so that splits and new roots happen all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4, true);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Scenario: concurrent writers insert disjoint keys while readers look up keys that were there all along.
+  const int64_t num_keys = 4000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key += 4) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+  std::atomic<bool> done{false};
+  auto lookup = [&](uint64_t thread_itr) {
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    int64_t key = thread_itr * 4;
+    while (!done) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      key = (key + 44) % num_keys;
+    }
+  };
+  std::vector<std::thread> readers;
+  for (uint64_t i = 0; i < 2; i++) {
+    readers.emplace_back(lookup, i);
+  }
+  keys.clear();
+  for (int64_t key = 0; key < num_keys; key++) {
+    if (key % 4 != 0) {
+      keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(4, InsertHelperSplit, &tree, keys, 4);
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  // every key is found, in both directions
+  int64_t current_key = 0;
+  for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key++;
+  }
+  EXPECT_EQ(num_keys, current_key);
+  for (auto iterator = tree.RBegin(); !iterator.isEnd(); ++iterator) {
+    current_key--;
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(0, current_key);
+
+  // Scenario: concurrent removes leave whole leaves empty, which lookups and scans skip.
+  std::vector<int64_t> remove_keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    if (key % 10 != 0) {
+      remove_keys.push_back(key);
+    }
+  }
+  LaunchParallelTest(4, DeleteHelperSplit, &tree, remove_keys, 4);
+  std::vector<GenericKey<8>> probe_keys(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    probe_keys[key].SetFromInteger(key);
+  }
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(probe_keys, &results);
+  for (int64_t key = 0; key < num_keys; key++) {
+    EXPECT_EQ(key % 10 == 0 ? 1U : 0U, results[key].size());
+  }
+  current_key = 0;
+  for (auto iterator = tree.begin(); !iterator.isEnd(); ++iterator) {
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+    current_key += 10;
+  }
+  EXPECT_EQ(num_keys, current_key);
+  for (auto iterator = tree.RBegin(); !iterator.isEnd(); ++iterator) {
+    current_key -= 10;
+    EXPECT_EQ(current_key, (*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(0, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -4,13 +4,18 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <map>
+#include <numeric>
 #include <random>
+#include <set>
+#include <string>
 #include <unordered_map>
 
 #include "b_plus_tree_test_util.h"  // NOLINT
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -173,6 +178,187 @@ TEST(BPlusTreeTests, DeleteTest2) {
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, DescendingScanTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // small nodes, so that a scan crosses many leaves and the separator keys of removed keys stay in the parents
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // an empty tree has no keys in either direction
+  EXPECT_TRUE(tree.RBegin().isEnd());
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 200; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  std::set<int64_t> expected;
+  for (auto key : keys) {
+    rid.Set(0, static_cast<uint32_t>(key));
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+    expected.insert(key);
+  }
+  for (auto key : keys) {
+    if (key % 3 == 0 || (key >= 50 && key <= 80)) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+      expected.erase(key);
+    }
+  }
+
+  // from the last key
+  auto expected_iter = expected.rbegin();
+  for (auto iterator = tree.RBegin(); !iterator.isEnd(); ++iterator, ++expected_iter) {
+    ASSERT_NE(expected_iter, expected.rend());
+    EXPECT_EQ(*expected_iter, (*iterator).second.GetSlotNum());
+  }
+  EXPECT_EQ(expected_iter, expected.rend());
+
+  // from the last key not greater than a present, removed, too small or too large key
+  for (int64_t start_key = -1; start_key <= 202; start_key++) {
+    index_key.SetFromInteger(start_key);
+    auto range_iter = std::make_reverse_iterator(expected.upper_bound(start_key));
+    for (auto iterator = tree.RBegin(index_key); !iterator.isEnd(); ++iterator, ++range_iter) {
+      ASSERT_NE(range_iter, expected.rend());
+      EXPECT_EQ(*range_iter, (*iterator).second.GetSlotNum());
+    }
+    EXPECT_EQ(range_iter, expected.rend());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, SlottedKeysTest) {
+  Schema *key_schema = ParseCreateStatement("a varchar(64)");
+  GenericComparator<64> comparator(key_schema);
+  using Tree = BPlusTree<GenericKey<64>, RID, GenericComparator<64>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // the same keys in fixed size and in slotted pages, the max sizes don't limit the slotted pages
+  Tree fixed_tree("foo_pk", bpm, comparator);
+  Tree tree("bar_pk", bpm, comparator, 1000, 1000, false, true);
+  // and in small slotted pages, so that internal pages are split, merged and redistributed too
+  Tree small_tree("baz_pk", bpm, comparator, 6, 6, false, true);
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // strings of 1 to 24 characters, sharing prefixes
+  auto make_key = [&](int i) {
+    std::string string = std::to_string(i * 7919 % 10007) + std::string(i % 17, 'k') + std::to_string(i);
+    GenericKey<64> index_key;
+    index_key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(string)}, key_schema), key_schema);
+    return std::make_pair(string, index_key);
+  };
+  const int num_keys = 10000;
+  std::vector<int> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  std::map<std::string, int> expected;
+  for (int i : keys) {
+    auto [string, index_key] = make_key(i);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, i), transaction));
+    EXPECT_TRUE(small_tree.Insert(index_key, RID(0, i), transaction));
+    fixed_tree.Insert(index_key, RID(0, i), transaction);
+    expected[string] = i;
+  }
+  EXPECT_FALSE(tree.Insert(make_key(keys[0]).second, RID(0, 0), transaction));
+
+  auto count_leaves = [&](Tree *counted_tree) {
+    Page *page = counted_tree->FindLeafPage(make_key(0).second, true);
+    page_id_t next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page->GetPageId(), false);
+    int num_leaves = 1;
+    for (; next_page_id != INVALID_PAGE_ID; num_leaves++) {
+      page = bpm->FetchPage(next_page_id);
+      next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+      bpm->UnpinPage(page->GetPageId(), false);
+    }
+    return num_leaves;
+  };
+  // a short key takes a fraction of the bytes of a GenericKey<64>
+  EXPECT_LT(2 * count_leaves(&tree), count_leaves(&fixed_tree));
+
+  auto check = [&](Tree *tree) {
+    std::vector<RID> rids;
+    for (int i = 0; i < num_keys; i++) {
+      auto [string, index_key] = make_key(i);
+      rids.clear();
+      ASSERT_EQ(expected.count(string) == 1, tree->GetValue(index_key, &rids));
+      if (!rids.empty()) {
+        EXPECT_EQ(i, rids[0].GetSlotNum());
+      }
+    }
+    auto expected_iter = expected.begin();
+    for (auto iterator = tree->begin(); !iterator.isEnd(); ++iterator, ++expected_iter) {
+      ASSERT_NE(expected_iter, expected.end());
+      EXPECT_EQ(expected_iter->second, (*iterator).second.GetSlotNum());
+    }
+    EXPECT_EQ(expected_iter, expected.end());
+    auto reverse_iter = expected.rbegin();
+    for (auto iterator = tree->RBegin(); !iterator.isEnd(); ++iterator, ++reverse_iter) {
+      ASSERT_NE(reverse_iter, expected.rend());
+      EXPECT_EQ(reverse_iter->second, (*iterator).second.GetSlotNum());
+    }
+    EXPECT_EQ(reverse_iter, expected.rend());
+  };
+  check(&tree);
+  check(&small_tree);
+
+  // removing most keys merges and redistributes the nodes, with separators of other lengths
+  for (int i : keys) {
+    if (i % 4 != 0) {
+      auto [string, index_key] = make_key(i);
+      tree.Remove(index_key, transaction);
+      small_tree.Remove(index_key, transaction);
+      expected.erase(string);
+    }
+  }
+  check(&tree);
+  check(&small_tree);
+
+  for (int i : keys) {
+    if (i % 4 != 0 && i % 3 == 0) {
+      auto [string, index_key] = make_key(i);
+      EXPECT_TRUE(tree.Insert(index_key, RID(0, i), transaction));
+      EXPECT_TRUE(small_tree.Insert(index_key, RID(0, i), transaction));
+      expected[string] = i;
+    }
+  }
+  check(&tree);
+  check(&small_tree);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 TEST(BPlusTreeTests, ConcurrentMixTest) {
   const int N_THREADS = 8;
   const int KEYS_PER_THREAD = 1 << 14;
@@ -142,6 +142,247 @@ TEST(BPlusTreeTests, InsertTest2) {
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, AppendSplitTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+  using Tree = BPlusTree<GenericKey<8>, RID, GenericComparator<8>>;
+  using LeafPage = BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  Tree tree("foo_pk", bpm, comparator, 20, 20);
+  GenericKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto count_leaves = [&]() {
+    Page *page = tree.FindLeafPage(index_key, true);
+    page_id_t next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page->GetPageId(), false);
+    int num_leaves = 1;
+    for (; next_page_id != INVALID_PAGE_ID; num_leaves++) {
+      page = bpm->FetchPage(next_page_id);
+      next_page_id = reinterpret_cast<LeafPage *>(page->GetData())->GetNextPageId();
+      bpm->UnpinPage(page->GetPageId(), false);
+    }
+    return num_leaves;
+  };
+  auto check = [&](const std::vector<int64_t> &keys) {
+    std::vector<RID> rids;
+    for (auto key : keys) {
+      rids.clear();
+      index_key.SetFromInteger(key);
+      EXPECT_TRUE(tree.GetValue(index_key, &rids));
+      EXPECT_EQ(rids.size(), 1);
+    }
+    auto key = keys.begin();
+    for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator, ++key) {
+      ASSERT_NE(key, keys.end());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), *key);
+    }
+    EXPECT_EQ(key, keys.end());
+  };
+
+  // increasing keys fill the leaves up: a leaf of max size 20 keeps 18 pairs instead of 10
+  const int64_t num_keys = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+    keys.push_back(key);
+  }
+  index_key.SetFromInteger(num_keys);
+  EXPECT_FALSE(tree.Insert(index_key, RID(0, num_keys), transaction));
+  EXPECT_LT(count_leaves(), num_keys / 15);
+  check(keys);
+
+  // merges take the right-most leaf away, and inserts in between stop the appends for a while
+  for (int64_t key = num_keys; key > num_keys / 2; key--) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+    keys.pop_back();
+  }
+  for (int64_t key = 1; key < num_keys / 2; key += 100) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+  }
+  for (int64_t key = num_keys / 2 + 1; key <= 2 * num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key), transaction));
+    keys.push_back(key);
+  }
+  check(keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 5, 5);
+  GenericKey<8> index_key;
+  RID rid;
+  // create transaction
+  Transaction *transaction = new Transaction(0);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // even keys in random order, each added twice with a different rid: only the first one must be loaded
+  const int64_t num_keys = 10000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys.push_back(2 * key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  // a budget of one page holds far fewer pairs than that, so the sort has to spill runs to disk
+  ExternalSorter<GenericKey<8>, RID, GenericComparator<8>> sorter(comparator, 1);
+  for (int copy = 0; copy < 2; copy++) {
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      sorter.Add(index_key, RID(copy, key));
+    }
+  }
+  EXPECT_LT(1U, sorter.GetNumSpilledRuns());
+  EXPECT_TRUE(tree.BulkLoad(&sorter));
+  EXPECT_EQ(static_cast<size_t>(num_keys), sorter.GetSize());
+  EXPECT_FALSE(tree.BulkLoad(&sorter));
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.begin(); iterator != tree.end(); ++iterator) {
+    auto location = (*iterator).second;
+    EXPECT_EQ(location.GetPageId(), 0);
+    EXPECT_EQ(location.GetSlotNum(), current_key);
+    current_key = current_key + 2;
+  }
+  EXPECT_EQ(current_key, 2 * num_keys);
+
+  // the leaves are as full as they can be without splitting on the next insert
+  int num_leaves = 0;
+  index_key.SetFromInteger(0);
+  Page *page = tree.FindLeafPage(index_key, true);
+  while (true) {
+    auto *leaf = reinterpret_cast<BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>> *>(page->GetData());
+    EXPECT_EQ(4, leaf->GetSize());
+    num_leaves++;
+    page_id_t next_page_id = leaf->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page->GetPageId(), false);
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    page = bpm->FetchPage(next_page_id);
+    page->RLatch();
+  }
+  EXPECT_EQ(num_keys / 4, num_leaves);
+
+  // the loaded tree takes inserts and removes like any other
+  for (auto key : keys) {
+    index_key.SetFromInteger(key + 1);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key + 1), transaction));
+    if (key % 4 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key, transaction);
+    }
+  }
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 2 * num_keys; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    bool removed = key % 4 == 0;
+    EXPECT_EQ(!removed, tree.GetValue(index_key, &rids));
+    if (!removed) {
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, GetValuesTest) {
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(50, disk_manager);
+  // small nodes, so that the probes cross leaves, parents and subtrees of the root
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  GenericKey<8> index_key;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // nothing is found in an empty tree
+  std::vector<GenericKey<8>> probe_keys(3);
+  std::vector<std::vector<RID>> results;
+  tree.GetValues(probe_keys, &results);
+  EXPECT_EQ(3U, results.size());
+  for (const auto &result : results) {
+    EXPECT_TRUE(result.empty());
+  }
+
+  for (int64_t key = 0; key < 400; key += 2) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, static_cast<uint32_t>(key)), transaction);
+  }
+
+  // present, missing, repeated and out of range keys, in random order
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(-10, 410);
+  for (size_t num_probes : {1, 10, 100, 1000}) {
+    std::vector<int64_t> probes;
+    probe_keys.resize(num_probes);
+    for (size_t i = 0; i < num_probes; i++) {
+      probes.push_back(dist(rng));
+      probe_keys[i].SetFromInteger(probes[i]);
+    }
+    tree.GetValues(probe_keys, &results);
+    ASSERT_EQ(num_probes, results.size());
+    for (size_t i = 0; i < num_probes; i++) {
+      if (probes[i] >= 0 && probes[i] < 400 && probes[i] % 2 == 0) {
+        ASSERT_EQ(1U, results[i].size());
+        EXPECT_EQ(probes[i], results[i][0].GetSlotNum());
+      } else {
+        EXPECT_TRUE(results[i].empty());
+      }
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 TEST(BPlusTreeTests, ConcurrentInsertTest) {
   const int N_THREADS = 8;
   const int KEYS_PER_THREAD = 1 << 14;
@@ -10,11 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdio>
 #include <cstring>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/segment.h"
 
 namespace bustub {
 
@@ -55,6 +60,48 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 8;
+  const int num_pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: threads write and read back disjoint pages at the same time.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&dm, tid]() {
+      char buf[PAGE_SIZE];
+      char data[PAGE_SIZE];
+      for (int i = 0; i < num_pages_per_thread; i++) {
+        page_id_t page_id = i * num_threads + tid;
+        std::memset(data, page_id % 128, sizeof(data));
+        dm.WritePage(page_id, data);
+        dm.ReadPage(page_id, buf);
+        EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * num_pages_per_thread, dm.GetNumWrites());
+
+  // Scenario: page writes are not synced one by one, only at explicit sync points.
+  EXPECT_EQ(0, dm.GetNumSyncs());
+  dm.SyncDatabase();
+  EXPECT_EQ(1, dm.GetNumSyncs());
+
+  // Scenario: a page past the end of the file reads as zeros.
+  char buf[PAGE_SIZE];
+  char zeros[PAGE_SIZE] = {0};
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(num_threads * num_pages_per_thread, buf);
+  EXPECT_EQ(std::memcmp(buf, zeros, sizeof(buf)), 0);
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +119,133 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageReuseTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  // spans two free map pages
+  const page_id_t num_pages = DiskManager::FREE_MAP_PAGE_CAPACITY + 10;
+
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t i = 0; i < num_pages; i++) {
+      EXPECT_EQ(i, dm.AllocatePage());
+    }
+    for (page_id_t page_id : {0, 5, num_pages - 1}) {
+      snprintf(data, sizeof(data), "page %d", page_id);
+      dm.WritePage(page_id, data);
+    }
+
+    // Scenario: freed pages are reused lowest id first, before the file grows.
+    dm.DeallocatePage(7);
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(num_pages);
+    EXPECT_EQ(2, dm.GetNumFreePages());
+    EXPECT_EQ(3, dm.AllocatePage());
+    // the reused page is marked allocated in the file before its id is handed out
+    FILE *file = fopen(db_file.c_str(), "rb");
+    ASSERT_NE(nullptr, file);
+    ASSERT_EQ(PAGE_SIZE, fread(buf, 1, PAGE_SIZE, file));
+    fclose(file);
+    EXPECT_EQ(1 << 7, buf[DiskManager::FREE_MAP_HEADER_SIZE] & 0xff);
+    EXPECT_EQ(7, dm.AllocatePage());
+    EXPECT_EQ(num_pages, dm.AllocatePage());
+    EXPECT_EQ(0, dm.GetNumFreePages());
+
+    // Scenario: the free map survives a restart. Page num_pages was never written, so it is gone after the restart.
+    dm.DeallocatePage(4);
+    dm.DeallocatePage(num_pages - 2);
+    dm.DeallocatePage(num_pages);
+    dm.ShutDown();
+  }
+
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(2, dm.GetNumFreePages());
+  EXPECT_EQ(4, dm.AllocatePage());
+  EXPECT_EQ(num_pages - 2, dm.AllocatePage());
+  EXPECT_EQ(num_pages, dm.AllocatePage());
+
+  // Scenario: the free map pages do not overlap any data page.
+  for (page_id_t page_id : {0, 5, num_pages - 1}) {
+    snprintf(data, sizeof(data), "page %d", page_id);
+    dm.ReadPage(page_id, buf);
+    EXPECT_STREQ(data, buf);
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SegmentTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  const size_t extent_size = 8;
+  Segment table_segment(extent_size);
+  Segment index_segment(extent_size);
+
+  // Scenario: pages allocated in turns by two segments are still contiguous within each segment.
+  std::vector<page_id_t> table_pages;
+  std::vector<page_id_t> index_pages;
+  for (size_t i = 0; i < 2 * extent_size; i++) {
+    table_pages.push_back(table_segment.AllocatePage(&dm));
+    index_pages.push_back(index_segment.AllocatePage(&dm));
+    dm.AllocatePage();
+  }
+  for (size_t i = 1; i < table_pages.size(); i++) {
+    if (i % extent_size != 0) {
+      EXPECT_EQ(table_pages[i - 1] + 1, table_pages[i]);
+      EXPECT_EQ(index_pages[i - 1] + 1, index_pages[i]);
+    }
+  }
+
+  // Scenario: an extent reuses a run of free pages that is long enough, and skips shorter ones.
+  dm.DeallocatePage(1);
+  for (page_id_t page_id : index_pages) {
+    dm.DeallocatePage(page_id);
+  }
+  page_id_t first_page_id = dm.AllocateExtent(extent_size);
+  EXPECT_EQ(index_pages[0], first_page_id);
+  EXPECT_EQ(index_pages[extent_size], dm.AllocateExtent(extent_size));
+  EXPECT_EQ(1, dm.GetNumFreePages());
+  EXPECT_EQ(1, dm.AllocatePage());
+
+  // Scenario: a segment frees the pages of its current extent it has not handed out when it is destroyed.
+  {
+    Segment segment(extent_size);
+    segment.AllocatePage(&dm);
+    segment.AllocatePage(&dm);
+    EXPECT_EQ(0, dm.GetNumFreePages());
+  }
+  EXPECT_EQ(extent_size - 2, dm.GetNumFreePages());
+
+  // Scenario: the segments that are still around when the disk manager shuts down free theirs then. The freed run is
+  // too short for an extent.
+  Segment segment(extent_size);
+  segment.AllocatePage(&dm);
+  EXPECT_EQ(extent_size - 2, dm.GetNumFreePages());
+  dm.ShutDown();
+  EXPECT_EQ(extent_size - 2 + extent_size - 1, dm.GetNumFreePages());
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FileFormatTest) {
+  std::string db_file("test.db");
+  { DiskManager("test.db").ShutDown(); }
+  EXPECT_NO_THROW(DiskManager("test.db").ShutDown());
+
+  // Scenario: a file that does not start with a free map page, e.g. one written before there was a free map, is
+  // rejected instead of having its first page taken for the free map.
+  char data[PAGE_SIZE] = {0};
+  snprintf(data, sizeof(data), "page 0");
+  FILE *file = fopen(db_file.c_str(), "wb");
+  ASSERT_NE(nullptr, file);
+  ASSERT_EQ(PAGE_SIZE, fwrite(data, 1, PAGE_SIZE, file));
+  fclose(file);
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_benchmark.cpp
+//
+// Identification: test/storage/disk_scheduler_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <future>  // NOLINT
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "storage/disk/disk_scheduler.h"
+
+/**
+ * Measures random page reads with one read in flight at a time and with 32 of them, for both backends of the disk
+ * scheduler. The file is smaller than the memory of most machines, so this measures the cost of submitting and
+ * completing requests more than the disk.
+ */
+namespace bustub {
+
+double RunReadWorkload(DiskManager *disk_manager, DiskScheduler::Backend backend, page_id_t num_pages,
+                       size_t num_reads, size_t queue_depth) {
+  DiskScheduler scheduler(disk_manager, queue_depth, backend);
+  if (scheduler.GetBackend() != backend) {
+    return 0;
+  }
+  std::vector<char> buf(queue_depth * PAGE_SIZE);
+  std::vector<std::future<bool>> futures(queue_depth);
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+  size_t num_failed = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < num_reads; i++) {
+    size_t slot = i % queue_depth;
+    if (futures[slot].valid() && !futures[slot].get()) {
+      num_failed++;
+    }
+    futures[slot] = scheduler.ScheduleRead(dist(rng), buf.data() + slot * PAGE_SIZE);
+  }
+  for (auto &future : futures) {
+    if (future.valid() && !future.get()) {
+      num_failed++;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  if (num_failed > 0) {
+    std::printf("%zu reads failed\n", num_failed);
+    std::exit(1);
+  }
+  return static_cast<double>(num_reads) / elapsed.count();
+}
+
+}  // namespace bustub
+
+int main() {
+  const bustub::page_id_t num_pages = 16384;
+  const size_t num_reads = 200000;
+
+  auto disk_manager = std::make_unique<bustub::DiskManager>("benchmark.db");
+  std::vector<char> data(bustub::PAGE_SIZE, 'x');
+  for (bustub::page_id_t i = 0; i < num_pages; i++) {
+    disk_manager->WritePage(i, data.data());
+  }
+  disk_manager->SyncDatabase();
+
+  for (auto backend : {bustub::DiskScheduler::Backend::IO_URING, bustub::DiskScheduler::Backend::THREAD_POOL}) {
+    const char *name = backend == bustub::DiskScheduler::Backend::IO_URING ? "io_uring" : "thread pool";
+    for (size_t queue_depth : {1, 32}) {
+      double throughput = bustub::RunReadWorkload(disk_manager.get(), backend, num_pages, num_reads, queue_depth);
+      if (throughput == 0) {
+        std::printf("%s: not available\n", name);
+        break;
+      }
+      std::printf("%s QD%zu: %.0f reads/s\n", name, queue_depth, throughput);
+    }
+  }
+
+  disk_manager->ShutDown();
+  std::remove("benchmark.db");
+  std::remove("benchmark.log");
+  return 0;
+}
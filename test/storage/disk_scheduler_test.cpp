@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::TestWithParam<DiskScheduler::Backend> {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, ScheduleTest) {
+  const page_id_t num_pages = 100;
+  DiskManager dm("test.db");
+  auto scheduler = std::make_unique<DiskScheduler>(&dm, 8, GetParam());
+
+  // Scenario: write a batch of pages, with a completion callback for each of them.
+  std::vector<char> data(num_pages * PAGE_SIZE);
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> futures;
+  std::atomic<int> num_completed{0};
+  for (page_id_t i = 0; i < num_pages; i++) {
+    snprintf(data.data() + i * PAGE_SIZE, PAGE_SIZE, "page %d", i);
+    requests.push_back({true, data.data() + i * PAGE_SIZE, i, std::promise<bool>(), [&](bool success) {
+                          EXPECT_TRUE(success);
+                          num_completed++;
+                        }});
+    futures.push_back(requests.back().callback_.get_future());
+  }
+  scheduler->Schedule(std::move(requests));
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+  EXPECT_EQ(num_pages, num_completed);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: read them back in reverse order, together with a page past the end of the file.
+  std::vector<char> buf((num_pages + 1) * PAGE_SIZE, 1);
+  futures.clear();
+  for (page_id_t i = num_pages; i >= 0; i--) {
+    futures.push_back(scheduler->ScheduleRead(i, buf.data() + i * PAGE_SIZE));
+  }
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+  EXPECT_EQ(0, memcmp(data.data(), buf.data(), data.size()));
+  std::vector<char> zeros(PAGE_SIZE, 0);
+  EXPECT_EQ(0, memcmp(zeros.data(), buf.data() + num_pages * PAGE_SIZE, PAGE_SIZE));
+
+  // Scenario: requests queued before the scheduler is destroyed are still performed.
+  snprintf(data.data(), PAGE_SIZE, "last write");
+  auto future = scheduler->ScheduleWrite(0, data.data());
+  scheduler.reset();
+  EXPECT_TRUE(future.get());
+  dm.ReadPage(0, buf.data());
+  EXPECT_STREQ("last write", buf.data());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_P(DiskSchedulerTest, QueueDepthTest) {
+  const page_id_t num_pages = 256;
+  const size_t num_reads = 2048;
+  const size_t queue_depth = 32;
+  DiskManager dm("test.db");
+  std::vector<char> data(PAGE_SIZE, 0);
+  for (page_id_t i = 0; i < num_pages; i++) {
+    snprintf(data.data(), PAGE_SIZE, "page %d", i);
+    dm.WritePage(i, data.data());
+  }
+
+  // Scenario: random reads with up to queue_depth of them in flight each complete into their own buffer.
+  DiskScheduler scheduler(&dm, queue_depth, GetParam());
+  std::vector<char> buf(queue_depth * PAGE_SIZE);
+  std::vector<std::future<bool>> futures(queue_depth);
+  std::vector<page_id_t> slot_page_ids(queue_depth);
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+  auto check = [&](size_t slot) {
+    if (futures[slot].valid()) {
+      EXPECT_TRUE(futures[slot].get());
+      EXPECT_EQ("page " + std::to_string(slot_page_ids[slot]), std::string(buf.data() + slot * PAGE_SIZE));
+    }
+  };
+  for (size_t i = 0; i < num_reads; i++) {
+    size_t slot = i % queue_depth;
+    check(slot);
+    slot_page_ids[slot] = dist(rng);
+    futures[slot] = scheduler.ScheduleRead(slot_page_ids[slot], buf.data() + slot * PAGE_SIZE);
+  }
+  for (size_t slot = 0; slot < queue_depth; slot++) {
+    check(slot);
+  }
+
+  dm.ShutDown();
+}
+
+INSTANTIATE_TEST_SUITE_P(DiskSchedulerBackends, DiskSchedulerTest,
+                         ::testing::Values(DiskScheduler::Backend::IO_URING, DiskScheduler::Backend::THREAD_POOL));
+
+}  // namespace bustub
@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map_page_test.cpp
+//
+// Identification: test/storage/free_space_map_page_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "storage/page/free_space_map_page.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FreeSpaceMapPageTest, FindTest) {
+  auto data = std::make_unique<char[]>(PAGE_SIZE);
+  auto page = reinterpret_cast<FreeSpaceMapPage *>(data.get());
+  page->Init(7);
+  EXPECT_EQ(7, page->GetPageId());
+  EXPECT_EQ(INVALID_PAGE_ID, page->GetNextPageId());
+  const uint32_t big = 8 * FreeSpaceMapPage::CATEGORY_SIZE;
+  const uint32_t small = 2 * FreeSpaceMapPage::CATEGORY_SIZE;
+  EXPECT_EQ(FreeSpaceMapPage::SLOTS, page->Find(small, 0));
+
+  // every table page is full, except for a few with some room and two with a lot of room
+  for (uint32_t slot = 0; slot < FreeSpaceMapPage::SLOTS; slot++) {
+    EXPECT_EQ(slot, page->Append(static_cast<page_id_t>(slot + 100), 0));
+  }
+  EXPECT_TRUE(page->IsFull());
+  page->SetFreeSpace(3, small);
+  page->SetFreeSpace(300, small);
+  page->SetFreeSpace(200, big);
+  page->SetFreeSpace(FreeSpaceMapPage::SLOTS - 1, big);
+  EXPECT_EQ(FreeSpaceMapPage::Category(big), page->GetMaxCategory());
+  EXPECT_EQ(300 + 100, page->TablePageIdAt(300));
+  EXPECT_EQ(FreeSpaceMapPage::Category(small), page->CategoryAt(300));
+
+  // the search starts at the given slot and wraps around to the first one
+  EXPECT_EQ(3U, page->Find(small, 0));
+  EXPECT_EQ(3U, page->Find(small, 3));
+  EXPECT_EQ(200U, page->Find(small, 4));
+  EXPECT_EQ(300U, page->Find(small, 201));
+  EXPECT_EQ(200U, page->Find(big, 0));
+  EXPECT_EQ(FreeSpaceMapPage::SLOTS - 1, page->Find(big, 201));
+  EXPECT_EQ(FreeSpaceMapPage::SLOTS, page->Find(big + 1, 0));
+
+  // filling a page lowers the maxima above it
+  page->SetFreeSpace(200, 0);
+  page->SetFreeSpace(FreeSpaceMapPage::SLOTS - 1, 0);
+  EXPECT_EQ(FreeSpaceMapPage::Category(small), page->GetMaxCategory());
+  EXPECT_EQ(3U, page->Find(small, 301));
+  EXPECT_EQ(FreeSpaceMapPage::SLOTS, page->Find(big, 0));
+}
+
+}  // namespace bustub
@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// generic_key_test.cpp
+//
+// Identification: test/storage/generic_key_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/key_search.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, NormalizedOrderTest) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 8), Column("c", TypeId::DECIMAL),
+                 Column("d", TypeId::SMALLINT)});
+  GenericComparator<32> comparator(&schema);
+
+  // few distinct values per column, so that the later columns often decide
+  std::mt19937 rng(0);
+  std::vector<std::string> strings = {"", "a", "ab", "b", std::string("a\0b", 3), "abc"};
+  std::vector<std::vector<Value>> rows;
+  for (int i = 0; i < 200; i++) {
+    int32_t a = static_cast<int32_t>(rng() % 5) - 2;
+    if (i % 50 == 0) {
+      a = i % 100 == 0 ? BUSTUB_INT32_MAX : BUSTUB_INT32_MIN;
+    }
+    double c = static_cast<int>(rng() % 7) - 3.5;
+    rows.push_back({ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(strings[rng() % strings.size()]),
+                    ValueFactory::GetDecimalValue(c),
+                    ValueFactory::GetSmallIntValue(static_cast<int16_t>(static_cast<int>(rng() % 3) - 1))});
+  }
+
+  std::vector<GenericKey<32>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    keys[i].SetFromKey(Tuple(rows[i], &schema), &schema);
+    // the columns can be read back
+    for (uint32_t col = 0; col < schema.GetColumnCount(); col++) {
+      EXPECT_EQ(CmpBool::CmpTrue, keys[i].ToValue(&schema, col).CompareEquals(rows[i][col]));
+    }
+  }
+
+  // comparing the bytes of two keys gives the same result as comparing their columns
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      int expected = 0;
+      for (uint32_t col = 0; col < schema.GetColumnCount() && expected == 0; col++) {
+        if (rows[i][col].CompareLessThan(rows[j][col]) == CmpBool::CmpTrue) {
+          expected = -1;
+        } else if (rows[i][col].CompareGreaterThan(rows[j][col]) == CmpBool::CmpTrue) {
+          expected = 1;
+        }
+      }
+      int cmp = comparator(keys[i], keys[j]);
+      EXPECT_EQ(expected, (cmp > 0) - (cmp < 0));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, IntegerTest) {
+  std::vector<int64_t> values = {BUSTUB_INT64_MIN, -1000, -1, 0, 1, 255, 256, 1000, BUSTUB_INT64_MAX};
+  Schema schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<8> comparator(&schema);
+  GenericKey<8> lhs;
+  GenericKey<8> rhs;
+  for (size_t i = 0; i < values.size(); i++) {
+    lhs.SetFromInteger(values[i]);
+    EXPECT_EQ(values[i], lhs.ToString());
+    for (size_t j = 0; j < values.size(); j++) {
+      rhs.SetFromInteger(values[j]);
+      int cmp = comparator(lhs, rhs);
+      EXPECT_EQ((i > j) - (i < j), (cmp > 0) - (cmp < 0));
+    }
+  }
+
+  // a key smaller than a BIGINT holds the integer like an INTEGER
+  std::vector<int64_t> small_values = {BUSTUB_INT32_MIN, -1000, -1, 0, 1, 255, 256, 1000, BUSTUB_INT32_MAX};
+  GenericComparator<4> small_comparator(&schema);
+  GenericKey<4> small_lhs;
+  GenericKey<4> small_rhs;
+  for (size_t i = 0; i < small_values.size(); i++) {
+    small_lhs.SetFromInteger(small_values[i]);
+    EXPECT_EQ(small_values[i], small_lhs.ToString());
+    for (size_t j = 0; j < small_values.size(); j++) {
+      small_rhs.SetFromInteger(small_values[j]);
+      int cmp = small_comparator(small_lhs, small_rhs);
+      EXPECT_EQ((i > j) - (i < j), (cmp > 0) - (cmp < 0));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(GenericKeyTest, KeySearchTest) {
+  Schema schema({Column("a", TypeId::BIGINT)});
+  GenericComparator<8> comparator(&schema);
+  using Search = KeySearch<GenericKey<8>, GenericComparator<8>>;
+
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(-1000, 1000);
+  // sizes around the scan window and the vector width, with pairs of leaf pages and of internal pages
+  for (int size = 0; size < 100; size++) {
+    std::vector<int64_t> values;
+    for (int i = 0; i < size; i++) {
+      values.push_back(dist(rng));
+    }
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    std::vector<std::pair<GenericKey<8>, RID>> leaf_pairs(values.size());
+    std::vector<std::pair<GenericKey<8>, page_id_t>> internal_pairs(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+      leaf_pairs[i].first.SetFromInteger(values[i]);
+      internal_pairs[i].first.SetFromInteger(values[i]);
+    }
+
+    for (int64_t target = -1002; target <= 1002; target++) {
+      GenericKey<8> key;
+      key.SetFromInteger(target);
+      auto n = static_cast<int>(values.size());
+      auto lower = static_cast<int>(std::lower_bound(values.begin(), values.end(), target) - values.begin());
+      auto upper = static_cast<int>(std::upper_bound(values.begin(), values.end(), target) - values.begin());
+      ASSERT_EQ(lower, Search::LowerBound(leaf_pairs.data(), n, key, comparator));
+      ASSERT_EQ(upper, Search::UpperBound(leaf_pairs.data(), n, key, comparator));
+      ASSERT_EQ(lower, Search::LowerBound(internal_pairs.data(), n, key, comparator));
+      ASSERT_EQ(upper, Search::UpperBound(internal_pairs.data(), n, key, comparator));
+    }
+  }
+}
+
+}  // namespace bustub
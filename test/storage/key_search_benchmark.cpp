@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search_benchmark.cpp
+//
+// Identification: test/storage/key_search_benchmark.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "storage/index/key_search.h"
+#include "storage/page/b_plus_tree_leaf_page.h"
+
+/**
+ * Measures the search for a key in a full B+ tree page of 8 byte keys. The page is searched by the KeySearch kernel for
+ * 8 byte keys, and by the generic binary search that calls the comparator. This is built twice: key_search_benchmark
+ * uses AVX2 when the machine has it, and key_search_scalar_benchmark never does, so comparing the two shows what the
+ * AVX2 scan of the last few pairs is worth.
+ */
+namespace bustub {
+
+/** Calls the comparator for 8 byte keys, so that the generic KeySearch is selected. */
+struct PlainComparator {
+  int operator()(const GenericKey<8> &lhs, const GenericKey<8> &rhs) const { return comparator_(lhs, rhs); }
+  GenericComparator<8> comparator_{nullptr};
+};
+
+template <typename ValueType>
+void RunKeySearchBenchmark(const char *page_type) {
+  const int num_rounds = 200;
+  const int num_keys = 1 << 16;
+  // as many pairs as fit into a page, leaf and internal pages have the same header
+  using KeyType = GenericKey<8>;
+  const int size = LEAF_PAGE_SIZE;
+
+  std::vector<MappingType> array(size);
+  for (int i = 0; i < size; i++) {
+    array[i].first.SetFromInteger(2 * i);
+  }
+  // half of the keys are in the page, the others fall between two of its keys
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<int64_t> dist(-1, 2 * size);
+  std::vector<GenericKey<8>> keys(num_keys);
+  for (auto &key : keys) {
+    key.SetFromInteger(dist(rng));
+  }
+
+  auto run = [&](const char *search_type, auto search) {
+    int64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < num_rounds; round++) {
+      for (const auto &key : keys) {
+        checksum += search(key);
+      }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf("%-8s page, %d pairs, %-7s search: %5.1f ns\n", page_type, size, search_type,
+                elapsed.count() / (num_rounds * num_keys));
+    return checksum;
+  };
+
+  GenericComparator<8> comparator{nullptr};
+  int64_t kernel_checksum = run("kernel", [&](const GenericKey<8> &key) {
+    return KeySearch<GenericKey<8>, GenericComparator<8>>::LowerBound(array.data(), size, key, comparator);
+  });
+  PlainComparator plain_comparator;
+  int64_t generic_checksum = run("generic", [&](const GenericKey<8> &key) {
+    return KeySearch<GenericKey<8>, PlainComparator>::LowerBound(array.data(), size, key, plain_comparator);
+  });
+  if (kernel_checksum != generic_checksum) {
+    std::printf("the searches disagree\n");
+    std::exit(1);
+  }
+}
+
+}  // namespace bustub
+
+int main() {
+#ifdef __AVX2__
+  std::printf("kernel: AVX2\n");
+#else
+  std::printf("kernel: scalar\n");
+#endif
+  bustub::RunKeySearchBenchmark<bustub::RID>("leaf");
+  bustub::RunKeySearchBenchmark<bustub::page_id_t>("internal");
+  return 0;
+}
@@ -0,0 +1,110 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_heap_test.cpp
+//
+// Identification: test/table/table_heap_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *buffer_pool_manager = new BufferPoolManager(50, disk_manager);
+  auto *lock_manager = new LockManager();
+  Transaction txn(0);
+  auto *table = new TableHeap(buffer_pool_manager, lock_manager, nullptr, &txn);
+
+  Schema schema({Column("a", TypeId::VARCHAR, 200)});
+  Tuple tuple({ValueFactory::GetVarcharValue(std::string(200, 'a'))}, &schema);
+  size_t num_tuples = 0;
+  auto insert = [&](TableHeap *table) {
+    RID rid;
+    EXPECT_TRUE(table->InsertTuple(tuple, &rid, &txn));
+    num_tuples++;
+    return rid;
+  };
+
+  // the first page records where the map of the table is
+  auto map_page_id = [&] {
+    auto first_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(table->GetFirstPageId()));
+    page_id_t page_id = first_page->GetFreeSpaceMapPageId();
+    buffer_pool_manager->UnpinPage(table->GetFirstPageId(), false);
+    return page_id;
+  };
+
+  // the pages fill up one after the other
+  std::vector<RID> rids;
+  std::vector<page_id_t> page_ids;
+  for (int i = 0; i < 200; i++) {
+    rids.push_back(insert(table));
+    if (page_ids.empty() || page_ids.back() != rids.back().GetPageId()) {
+      page_ids.push_back(rids.back().GetPageId());
+    }
+  }
+  ASSERT_GT(page_ids.size(), 5U);
+  page_id_t first_map_page_id = map_page_id();
+  ASSERT_NE(INVALID_PAGE_ID, first_map_page_id);
+  EXPECT_EQ(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), first_map_page_id));
+
+  // deleting the tuples of a page in the middle of the chain makes room in it
+  int freed = 0;
+  for (const auto &rid : rids) {
+    if (rid.GetPageId() == page_ids[2]) {
+      table->ApplyDelete(rid, &txn);
+      num_tuples--;
+      freed++;
+    }
+  }
+  // inserts go on with the last page, and then wrap around to the page with room instead of appending a new one
+  RID rid = insert(table);
+  while (rid.GetPageId() == page_ids.back()) {
+    rid = insert(table);
+  }
+  EXPECT_EQ(page_ids[2], rid.GetPageId());
+  for (int i = 1; i < freed / 2; i++) {
+    EXPECT_EQ(page_ids[2], insert(table).GetPageId());
+  }
+
+  // a reopened table attaches to the map of the table instead of building a new one; the map counts a new slot for
+  // every insert, so the room of the last deleted tuple may look too small for another one
+  auto *reopened = new TableHeap(buffer_pool_manager, lock_manager, nullptr, table->GetFirstPageId());
+  for (int i = freed / 2; i < freed - 1; i++) {
+    EXPECT_EQ(page_ids[2], insert(reopened).GetPageId());
+  }
+  EXPECT_EQ(first_map_page_id, map_page_id());
+  // and appends a new page once the table is full
+  rid = insert(reopened);
+  EXPECT_EQ(page_ids.end(), std::find(page_ids.begin(), page_ids.end(), rid.GetPageId()));
+
+  size_t count = 0;
+  for (auto iter = reopened->Begin(&txn); iter != reopened->End(); ++iter) {
+    count++;
+  }
+  EXPECT_EQ(num_tuples, count);
+
+  delete reopened;
+  delete table;
+  delete lock_manager;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete buffer_pool_manager;
+  delete disk_manager;
+}
+
+}  // namespace bustub